@@ -0,0 +1,718 @@
+// 日志系统的行为测试：每个用例构建自己的日志器，析构日志器后读回输出文件检查结果
+// 编译：g++ -std=c++17 behavior_test.cpp -o behavior_test -lpthread -ljsoncpp
+// 与test.cpp一样在examples目录下运行，全部通过时返回0
+#include <unistd.h> // 用于_exit
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../logs_code/MyLog.hpp"
+#include "../logs_code/ThreadPoll.hpp"
+#include "../logs_code/Util.hpp"
+using std::cout;
+using std::endl;
+
+ThreadPool* tp = nullptr;
+mylog::Util::JsonData* g_conf_data;
+
+static int failures = 0; // 失败的检查数
+
+// CHECK：检查失败时打印位置和条件，继续执行后面的检查
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            cout << __FILE__ << __LINE__ << " check failed: " #cond << endl;     \
+            ++failures;                                                          \
+        }                                                                        \
+    } while (0)
+
+static const std::string kDir = "./logfile/behavior/"; // 测试输出目录
+
+// 测试输出文件的完整路径，先删除上一次运行留下的文件（刷新器以追加方式打开）
+static std::string Fresh(const std::string& name)
+{
+    std::string path = kDir + name;
+    remove(path.c_str());
+    return path;
+}
+
+static std::string ReadFile(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+// 按行拆分文件内容
+static std::vector<std::string> Lines(const std::string& text)
+{
+    std::vector<std::string> lines;
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line))
+        lines.push_back(line);
+    return lines;
+}
+
+// 包含needle的行数
+static size_t CountLines(const std::string& text, const std::string& needle)
+{
+    size_t n = 0;
+    for (auto& line : Lines(text))
+        if (line.find(needle) != std::string::npos)
+            ++n;
+    return n;
+}
+
+// 线程暂存区中还有数据、消费者正忙着写入时析构日志器：不能死锁，暂存的日志全部落地
+static void TestStagingShutdown()
+{
+    const int kThreads = 32, kRecords = 200;
+    std::string path = Fresh("staging.log");
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("staging_shutdown");
+        builder.BuildLoggerFlush<mylog::FileFlush>(path);
+        mylog::StagingPolicy staging;
+        staging.batch_bytes = 4 * 1024 * 1024; // 大批次：数据留在暂存区中，由析构时的FlushAll交出
+        staging.max_delay = std::chrono::milliseconds(20);
+        builder.BuildStaging(staging);
+        mylog::AsyncLogger::ptr logger = builder.Build();
+
+        std::string body(2000, 'x');
+        std::atomic<int> done{0};
+        std::atomic<bool> released{false};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < kRecords; ++i)
+                    MYLOG_INFO(logger, "staged {}", body);
+                ++done;
+                while (!released) // 线程不退出，暂存区中的数据只能由析构交出
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+        }
+        while (done < kThreads)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        logger.reset();
+        released = true;
+        for (auto& t : threads)
+            t.join();
+    }
+    CHECK(CountLines(ReadFile(path), "staged x") == (size_t)kThreads * kRecords);
+}
+
+// 按时间戳合并：其他线程没有暂存数据时交出的日志不用再等待固定的延迟；多个线程交错写入时输出严格按产生的顺序
+static void TestMergeByTime()
+{
+    const int kThreads = 4, kRecords = 50;
+    std::string path = Fresh("merge.log");
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("merge_by_time");
+        builder.BuildLoggerFlush<mylog::FileFlush>(path);
+        mylog::SyncPolicy flush_only;
+        flush_only.mode = 1; // 每批fflush，可以直接读文件
+        builder.BuildFlushSync(flush_only);
+        mylog::StagingPolicy staging;
+        staging.batch_bytes = 4 * 1024 * 1024;
+        staging.max_delay = std::chrono::milliseconds(500);
+        staging.merge_by_time = true;
+        builder.BuildStaging(staging);
+        mylog::AsyncLogger::ptr logger = builder.Build();
+
+        auto start = std::chrono::steady_clock::now();
+        MYLOG_INFO(logger, "merge first");
+        logger->FlushThreadBuffer();
+        while (CountLines(ReadFile(path), "merge first") == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        // 消费者最多max_delay醒来一次，取到后立即输出，不再等两倍max_delay的水位线
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(900));
+
+        std::mutex order;
+        int next = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < kRecords; ++i) {
+                    {
+                        std::lock_guard<std::mutex> lock(order); // 序号与时间戳的顺序一致
+                        MYLOG_INFO(logger, "merge seq {}", next++);
+                    }
+                    if ((i + t) % 7 == 0)
+                        logger->FlushThreadBuffer();
+                    if (i % 10 == 0)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+        }
+        for (auto& th : threads)
+            th.join();
+    }
+    int expect = 0;
+    for (auto& line : Lines(ReadFile(path))) {
+        size_t pos = line.find("merge seq ");
+        if (pos == std::string::npos)
+            continue;
+        CHECK(std::stoi(line.substr(pos + 10)) == expect);
+        ++expect;
+    }
+    CHECK(expect == kThreads * kRecords);
+}
+
+// 析构时保存同步统计的文件刷新器，日志器析构后仍能检查每个刷新器同步了多少次
+class StatsFileFlush : public mylog::FileFlush
+{
+public:
+    StatsFileFlush(const std::string& filename, mylog::SyncStats* stats) : FileFlush(filename), stats_(stats) {}
+    ~StatsFileFlush() { *stats_ = GetSyncStats(); }
+
+private:
+    mylog::SyncStats* stats_;
+};
+
+// 按等级掩码路由到两个文件：ERROR/FATAL文件每批同步磁盘，DEBUG/INFO文件不同步，WARN两边都不接收
+static void TestLevelRouting()
+{
+    using mylog::LogLevel;
+    std::string error_path = Fresh("route_error.log");
+    std::string info_path = Fresh("route_info.log");
+    mylog::SyncStats error_stats, info_stats;
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("level_routing");
+        builder.BuildLoggerFlush<StatsFileFlush>(error_path, &error_stats);
+        builder.BuildFlushLevels(LogLevel::Range(LogLevel::value::ERROR, LogLevel::value::FATAL));
+        mylog::SyncPolicy durable;
+        durable.mode = 2; // interval和bytes都为0：每批同步一次
+        durable.sync_on_error = true;
+        builder.BuildFlushSync(durable);
+        builder.BuildLoggerFlush<StatsFileFlush>(info_path, &info_stats);
+        builder.BuildFlushLevels(LogLevel::Range(LogLevel::value::DEBUG, LogLevel::value::INFO));
+        builder.BuildFlushSync(mylog::SyncPolicy()); // 不同步磁盘
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        for (int i = 0; i < 10; ++i) {
+            MYLOG_DEBUG(logger, "route debug {}", i);
+            MYLOG_INFO(logger, "route info {}", i);
+            MYLOG_WARN(logger, "route warn {}", i);
+            MYLOG_ERROR(logger, "route error {}", i);
+            MYLOG_FATAL(logger, "route fatal {}", i);
+        }
+    }
+    std::string error_text = ReadFile(error_path), info_text = ReadFile(info_path);
+    CHECK(Lines(error_text).size() == 20);
+    CHECK(CountLines(error_text, "route error") == 10);
+    CHECK(CountLines(error_text, "route fatal") == 10);
+    CHECK(Lines(info_text).size() == 20);
+    CHECK(CountLines(info_text, "route debug") == 10);
+    CHECK(CountLines(info_text, "route info") == 10);
+    CHECK(error_stats.syncs > 0);
+    CHECK(info_stats.syncs == 0);
+}
+
+// sync_on_error按每批实际写入的等级同步：只有写入了ERROR的那一批同步，下一批不跟着同步，
+// 不接收ERROR的刷新器即使要求sync_on_error也不同步
+static void TestSyncOnErrorLevels()
+{
+    using mylog::LogLevel;
+    for (auto buffer_type : {mylog::BufferType::DOUBLE_BUFFER, mylog::BufferType::RING_BUFFER}) {
+        std::string all_path = Fresh("sync_error_all.log");
+        std::string info_path = Fresh("sync_error_info.log");
+        mylog::SyncStats all_stats, info_stats;
+        {
+            mylog::LoggerBuilder builder;
+            builder.BuildLoggerName("sync_on_error");
+            builder.BuildBufferType(buffer_type);
+            mylog::SyncPolicy grouped;
+            grouped.mode = 2;
+            grouped.interval = std::chrono::milliseconds(60000); // 只有sync_on_error会在日志器运行期间同步
+            grouped.sync_on_error = true;
+            builder.BuildLoggerFlush<StatsFileFlush>(all_path, &all_stats);
+            builder.BuildFlushSync(grouped);
+            builder.BuildLoggerFlush<StatsFileFlush>(info_path, &info_stats);
+            builder.BuildFlushLevels(LogLevel::Range(LogLevel::value::DEBUG, LogLevel::value::INFO));
+            builder.BuildFlushSync(grouped);
+            mylog::AsyncLogger::ptr logger = builder.Build();
+            // 等上一条落地后再写下一条，每条日志单独成一批
+            auto write = [&](LogLevel::value level, const std::string& tag) {
+                MYLOG_LOG(logger, level, "{}", tag);
+                for (int i = 0; i < 500 && CountLines(ReadFile(all_path), tag) == 0; ++i)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            };
+            write(LogLevel::value::INFO, "sync before");
+            write(LogLevel::value::ERROR, "sync error");
+            write(LogLevel::value::INFO, "sync after");
+            CHECK(all_stats.syncs == 0 && info_stats.syncs == 0); // 还没有析构，统计在析构时保存
+        }
+        CHECK(all_stats.syncs == 1);
+        CHECK(info_stats.syncs == 0);
+    }
+}
+
+// 重复日志折叠：窗口内同一调用点的相同日志只输出一次，内容变化或日志器析构时补上重复次数
+static void TestCoalescing()
+{
+    std::string path = Fresh("coalesce.log");
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("coalescing");
+        builder.BuildLoggerFlush<mylog::FileFlush>(path);
+        builder.BuildCoalesce(std::chrono::seconds(10)); // 测试期间窗口不会结束
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        for (int i = 0; i < 50; ++i)
+            MYLOG_INFO(logger, "coalesce same");
+        for (int i = 0; i < 6; ++i)
+            MYLOG_WARN(logger, "coalesce changed {}", i < 5 ? "a" : "b");
+    }
+    std::vector<std::string> lines = Lines(ReadFile(path));
+    CHECK(lines.size() == 5);
+    if (lines.size() != 5)
+        return;
+    // 内容变化时先补上重复次数，再输出新的内容；提示沿用被折叠日志的等级
+    CHECK(lines[0].find("coalesce same") != std::string::npos);
+    CHECK(lines[1].find("coalesce changed a") != std::string::npos);
+    CHECK(lines[2].find("last message repeated 4 times") != std::string::npos);
+    CHECK(lines[2].find("[WARN]") != std::string::npos);
+    CHECK(lines[3].find("coalesce changed b") != std::string::npos);
+    // 窗口没有结束的调用点在日志器析构时补上
+    CHECK(lines[4].find("last message repeated 49 times") != std::string::npos);
+    CHECK(lines[4].find("[INFO]") != std::string::npos);
+}
+
+// 调用点限流：被拦下的条数由空闲的消费者定时报告（日志器创建时还没有限流的调用点），
+// 等级不够的MYLOG_ALLOW不消耗令牌也不计入被拦下的条数
+static void TestRateLimit()
+{
+    using mylog::LogLevel;
+    std::string path = Fresh("ratelimit.log");
+    std::string text;
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("rate_limit");
+        builder.BuildLoggerFlush<mylog::FileFlush>(path);
+        mylog::SyncPolicy flush_only;
+        flush_only.mode = 1; // 每批fflush，可以直接读文件；没有按时间同步，空闲时只有限流报告需要定时醒来
+        builder.BuildFlushSync(flush_only);
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        logger->SetLevel(LogLevel::value::WARN);
+        int filtered = 0;
+        for (int i = 0; i < 5; ++i)
+            if (MYLOG_ALLOW(logger, LogLevel::value::INFO, mylog::LimitPolicy::Rate(1)))
+                ++filtered;
+        CHECK(filtered == 0);
+        auto limited = [&](int i) { MYLOG_WARN_RATE(logger, 1, "limited {}", i); }; // 1秒内只放行第一条
+        limited(0);
+        // 第一条落地后才开始被拦下，只能由空闲的消费者定时报告
+        for (int i = 0; i < 50 && CountLines(text, "limited 0") == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            text = ReadFile(path);
+        }
+        for (int i = 1; i < 100; ++i)
+            limited(i);
+        for (int i = 0; i < 50 && CountLines(text, "messages suppressed") == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            text = ReadFile(path);
+        }
+    }
+    CHECK(CountLines(text, "limited 0") == 1);
+    CHECK(CountLines(text, "limited") == 1);
+    CHECK(CountLines(text, "99 messages suppressed by rate limit at behavior_test.cpp") == 1);
+    text = ReadFile(path);
+    CHECK(CountLines(text, "messages suppressed") == 1); // 等级不够的调用点没有被拦下的条数
+}
+
+// 多个日志器共用的限流调用点，日志器由参数传入
+static void SampledStep(const mylog::AsyncLogger::ptr& logger, int i)
+{
+    MYLOG_INFO_EVERY_N(logger, 10, "sampled {}", i);
+}
+
+// 同一个限流调用点轮流使用两个日志器：每个日志器报告的被拦下条数加上输出的条数等于它的调用次数
+static void TestSharedLimitSite()
+{
+    const int kCalls[] = {100, 50};
+    std::string paths[] = {Fresh("shared_limit_a.log"), Fresh("shared_limit_b.log")};
+    {
+        mylog::AsyncLogger::ptr loggers[2];
+        for (int k = 0; k < 2; ++k) {
+            mylog::LoggerBuilder builder;
+            builder.BuildLoggerName(k == 0 ? "shared_limit_a" : "shared_limit_b");
+            builder.BuildLoggerFlush<mylog::FileFlush>(paths[k]);
+            loggers[k] = builder.Build();
+        }
+        for (int i = 0; i < kCalls[0]; ++i) {
+            SampledStep(loggers[0], i);
+            if (i < kCalls[1])
+                SampledStep(loggers[1], i);
+        }
+    }
+    for (int k = 0; k < 2; ++k) {
+        std::string text = ReadFile(paths[k]);
+        size_t reported = 0;
+        for (auto& line : Lines(text)) {
+            size_t pos = line.find(" messages suppressed by rate limit at ");
+            if (pos != std::string::npos) {
+                size_t begin = line.rfind('\t', pos) + 1;
+                reported += std::stoul(line.substr(begin, pos - begin));
+            }
+        }
+        CHECK(CountLines(text, "sampled ") + reported == (size_t)kCalls[k]);
+    }
+}
+
+// 记录交给滚动处理器的文件名
+class RecordingRollHandler : public mylog::RollHandler
+{
+public:
+    void OnRolled(const std::string& filename) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        files.push_back(filename);
+    }
+    std::mutex mtx;
+    std::vector<std::string> files;
+};
+
+// 日志器析构时正在写的最后一个滚动文件也交给处理器（例如压缩），而且交出时内容已经完整
+static void TestRollHandlerOnShutdown()
+{
+    for (int kind = 0; kind < 3; ++kind) {
+        std::string base = Fresh("roll_handler_" + std::to_string(kind));
+        auto handler = std::make_shared<RecordingRollHandler>();
+        {
+            mylog::LoggerBuilder builder;
+            builder.BuildLoggerName("roll_handler");
+            if (kind == 0)
+                builder.BuildLoggerFlush<mylog::RollFileFlush>(base, 1024 * 1024, handler);
+            else if (kind == 1)
+                builder.BuildLoggerFlush<mylog::RawFileFlush>(base, 1024 * 1024, handler);
+            else
+                builder.BuildLoggerFlush<mylog::MmapFileFlush>(base, 1024 * 1024, handler);
+            mylog::AsyncLogger::ptr logger = builder.Build();
+            for (int i = 0; i < 3; ++i)
+                MYLOG_INFO(logger, "roll handler {}", i);
+        }
+        CHECK(handler->files.size() == 1);
+        if (!handler->files.empty())
+            CHECK(CountLines(ReadFile(handler->files[0]), "roll handler") == 3);
+    }
+}
+
+// JSON lines输出：每条日志一行一个JSON对象，信息体和KV字段中的引号、反斜杠、换行和控制字符转义后能原样解析回来，
+// 数值和布尔字段保持类型
+static void TestJsonLines()
+{
+    std::string path = Fresh("json.log");
+    const std::string msg_arg = "tab\there \"quoted\"";
+    const std::string quote = "say \"hi\"";
+    const std::string backslash = "C:\\logs\\app";
+    const std::string multiline = "line1\nline2\r\n\x01end";
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("json_lines");
+        builder.BuildLoggerFlush<mylog::FileFlush>(path);
+        builder.BuildPattern(mylog::Pattern::kJson);
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        for (int i = 0; i < 3; ++i)
+            MYLOG_INFO(logger, "json {} {}", i, msg_arg, mylog::KV("quote", quote), mylog::KV("path", backslash),
+                mylog::KV("multi", multiline), mylog::KV("count", 42 + i), mylog::KV("ok", true));
+    }
+    std::vector<std::string> lines = Lines(ReadFile(path));
+    CHECK(lines.size() == 3); // 换行被转义，每条日志仍是一行
+    Json::CharReaderBuilder rb;
+    std::unique_ptr<Json::CharReader> reader(rb.newCharReader());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        Json::Value root;
+        std::string err;
+        bool ok = reader->parse(lines[i].data(), lines[i].data() + lines[i].size(), &root, &err);
+        CHECK(ok);
+        if (!ok)
+            continue;
+        CHECK(root["level"].asString() == "INFO");
+        CHECK(root["logger"].asString() == "json_lines");
+        CHECK(root["msg"].asString() == "json " + std::to_string(i) + " " + msg_arg);
+        CHECK(root["quote"].asString() == quote);
+        CHECK(root["path"].asString() == backslash);
+        CHECK(root["multi"].asString() == multiline);
+        CHECK(root["count"].isInt() && root["count"].asInt() == 42 + (int)i);
+        CHECK(root["ok"].isBool() && root["ok"].asBool());
+    }
+}
+
+// 写入前等待放行的文件刷新器，用来让消费者卡在落地中，生产者缓冲区积压到过载上限
+class GateFileFlush : public mylog::FileFlush
+{
+public:
+    GateFileFlush(const std::string& filename, std::atomic<int>* state) : FileFlush(filename), state_(state) {}
+    void FlushV(const struct iovec* iov, int iovcnt) override
+    {
+        if (state_->load() == 0)
+            state_->store(1); // 消费者已进入刷新器
+        while (state_->load() != 2)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        FileFlush::FlushV(iov, iovcnt);
+    }
+
+private:
+    std::atomic<int>* state_; // 0未进入，1等待放行，2已放行
+};
+
+// 线程暂存加过载丢弃：暂存的一批日志逐条按等级丢弃，丢弃提示中的条数等于实际少写的条数
+static void TestStagedOverload()
+{
+    using mylog::LogLevel;
+    const int kRounds = 300, kDebugPerRound = 10;
+    std::string path = Fresh("staged_overload.log");
+    std::atomic<int> gate{0};
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("staged_overload");
+        builder.BuildLopperType(mylog::AsyncType::ASYNC_UNSAFE);
+        builder.BuildLoggerFlush<GateFileFlush>(path, &gate);
+        mylog::OverloadPolicy overload;
+        overload.max_bytes = 64 * 1024;
+        overload.drop = mylog::DropPolicy::DROP_LOWEST_LEVEL;
+        builder.BuildOverloadPolicy(overload);
+        mylog::StagingPolicy staging;
+        staging.batch_bytes = 4 * 1024;
+        builder.BuildStaging(staging);
+        mylog::AsyncLogger::ptr logger = builder.Build();
+
+        MYLOG_ERROR(logger, "overload warmup"); // ERROR不在暂存区滞留，消费者拿到后卡在刷新器中
+        while (gate.load() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::string body(100, 'o');
+        for (int r = 0; r < kRounds; ++r) {
+            for (int i = 0; i < kDebugPerRound; ++i)
+                MYLOG_DEBUG(logger, "overload debug {}", body);
+            MYLOG_INFO(logger, "overload info {}", body);
+            MYLOG_ERROR(logger, "overload error {}", body);
+        }
+        gate.store(2);
+    }
+    std::string text = ReadFile(path);
+    size_t debug = CountLines(text, "overload debug"), errors = CountLines(text, "[ERROR][staged_overload]");
+    size_t info = CountLines(text, "[INFO][staged_overload]");
+    size_t reported = 0;
+    for (auto& line : Lines(text)) {
+        size_t pos = line.find(" messages (");
+        if (pos != std::string::npos && line.find("dropped due to overload") != std::string::npos) {
+            size_t begin = line.rfind('\t', pos) + 1;
+            reported += std::stoul(line.substr(begin, pos - begin));
+        }
+    }
+    size_t produced = 1 + kRounds * (kDebugPerRound + 2);
+    size_t written = debug + info + errors;
+    CHECK(written < produced); // 确实发生了过载
+    CHECK(written + reported == produced); // 每条被丢弃的日志都计入提示
+    // DEBUG到一半容量就开始丢弃，ERROR到上限才丢弃：同一批中的DEBUG不能借ERROR的等级通过
+    CHECK(2 * debug * (kRounds + 1) < errors * (kRounds * kDebugPerRound));
+}
+
+// 环形缓冲区ASYNC_SAFE：缓冲区满时生产者挂起，消费者取走数据后唤醒它们，一条日志都不丢
+static void TestRingFullSafe()
+{
+    const int kThreads = 4, kRecords = 2000;
+    std::string path = Fresh("ring_full.log");
+    std::atomic<int> gate{0};
+    std::atomic<int> written{0};
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("ring_full");
+        builder.BuildLopperType(mylog::AsyncType::ASYNC_SAFE);
+        builder.BuildBufferType(mylog::BufferType::RING_BUFFER);
+        builder.BuildLoggerFlush<GateFileFlush>(path, &gate);
+        size_t capacity = g_conf_data->ring_capacity;
+        g_conf_data->ring_capacity = 1024; // 最小的环形缓冲区，只在创建时读取
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        g_conf_data->ring_capacity = capacity;
+
+        MYLOG_INFO(logger, "ring warmup"); // 消费者拿到后卡在刷新器中，之后的日志只能留在环形缓冲区
+        while (gate.load() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::string body(100, 'r');
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t)
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < kRecords; ++i) {
+                    MYLOG_INFO(logger, "ring record {} {} {}", t, i, body);
+                    written.fetch_add(1);
+                }
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK(written.load() < kThreads * kRecords); // 环形缓冲区已满，生产者在等待空间
+        gate.store(2);
+        for (auto& th : threads)
+            th.join();
+        CHECK(logger->DroppedCount() == 0);
+    }
+    std::string text = ReadFile(path);
+    CHECK(CountLines(text, "ring record") == (size_t)(kThreads * kRecords));
+}
+
+// Reserve只给出上限，过载策略在Commit时按实际写入的长度判断，丢弃的字节数也按实际长度计
+static void TestReserveCommit()
+{
+    using mylog::LogLevel;
+    std::atomic<int> gate{0};
+    mylog::OverloadPolicy overload;
+    overload.max_bytes = 1000;
+    mylog::AsyncWorker worker([&](mylog::Buffer&) {
+        if (gate.load() == 0) { // 第一批卡在回调中，之后写入的数据留在生产者缓冲区
+            gate.store(1);
+            while (gate.load() != 2)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }, mylog::AsyncType::ASYNC_UNSAFE, mylog::BufferType::DOUBLE_BUFFER, mylog::WaitPolicy(), overload);
+    auto write = [&](size_t len) {
+        char* p = worker.Reserve(4096, LogLevel::value::INFO); // 预留超过上限的空间
+        memset(p, 'r', len);
+        return worker.Commit(len);
+    };
+    CHECK(write(100));
+    while (gate.load() == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CHECK(write(600));
+    CHECK(!write(600)); // 600 + 600超过上限
+    CHECK(worker.DroppedCount() == 1 && worker.DroppedBytes() == 600);
+    gate.store(2);
+}
+
+// 运行时决定等级的调用点：每条记录按自己的等级输出和路由，不沿用第一次调用时的等级
+static void TestRuntimeLevel()
+{
+    using mylog::LogLevel;
+    const LogLevel::value levels[] = {LogLevel::value::INFO, LogLevel::value::ERROR, LogLevel::value::WARN};
+    for (bool deferred : {false, true}) {
+        std::string path = Fresh(deferred ? "level_deferred.log" : "level_direct.log");
+        std::string error_path = Fresh(deferred ? "level_deferred_error.log" : "level_direct_error.log");
+        {
+            mylog::LoggerBuilder builder;
+            builder.BuildLoggerName("runtime_level");
+            builder.BuildLoggerFlush<mylog::FileFlush>(path);
+            if (deferred) {
+                builder.BuildLoggerFlush<mylog::FileFlush>(error_path); // 等级掩码使日志器按记录头中的等级路由
+                builder.BuildFlushLevels(LogLevel::Bit(LogLevel::value::ERROR));
+            }
+            mylog::AsyncLogger::ptr logger = builder.Build();
+            for (int i = 0; i < 6; ++i)
+                MYLOG_LOG(logger, levels[i % 3], "dynamic {}", i);
+        }
+        std::vector<std::string> lines = Lines(ReadFile(path));
+        CHECK(lines.size() == 6);
+        for (size_t i = 0; i < lines.size(); ++i) {
+            std::string tag = std::string("[") + LogLevel::ToString(levels[i % 3]) + "]";
+            CHECK(lines[i].find(tag) != std::string::npos);
+            CHECK(lines[i].find("dynamic " + std::to_string(i)) != std::string::npos);
+        }
+        if (deferred)
+            CHECK(CountLines(ReadFile(error_path), "[ERROR]") == 2 && Lines(ReadFile(error_path)).size() == 2);
+    }
+}
+
+// 远程备份由消费者线程中的BackupFlush提交：INFO/WARN不进入备份队列，ERROR/FATAL按批成帧
+static void TestBackupSink()
+{
+    using mylog::LogLevel;
+    mylog::BackupClient& client = mylog::BackupClient::GetInstance();
+    size_t before = client.SubmittedCount() + client.DroppedCount();
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("backup_sink");
+        builder.BuildBackup();
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        for (int i = 0; i < 100; ++i) {
+            MYLOG_INFO(logger, "not backed up {}", i);
+            MYLOG_WARN(logger, "not backed up {}", i);
+        }
+    }
+    CHECK(client.SubmittedCount() + client.DroppedCount() == before);
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("backup_sink");
+        builder.BuildBackup();
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        for (int i = 0; i < 100; ++i)
+            MYLOG_ERROR(logger, "backed up {}", i);
+    }
+    size_t frames = client.SubmittedCount() + client.DroppedCount() - before;
+    CHECK(frames >= 1 && frames <= 100);
+}
+
+// 调用点表已满：之后登记的调用点不覆盖已有的槽位，由调用线程立即格式化，文件、行号、等级和格式串都不混淆
+// 会占满全局调用点表，必须最后执行
+static void TestCallSiteOverflow()
+{
+    std::string path = Fresh("callsite.log");
+    int registered_line = 0, first_line = 0, second_line = 0;
+    {
+        mylog::LoggerBuilder builder;
+        builder.BuildLoggerName("callsite_overflow");
+        builder.BuildLoggerFlush<mylog::FileFlush>(path);
+        builder.BuildDeferredFormat();
+        mylog::AsyncLogger::ptr logger = builder.Build();
+        auto registered = [&](int i) {
+            registered_line = __LINE__ + 1;
+            MYLOG_ERROR(logger, "registered {}", i);
+        };
+        registered(0); // 表满之前登记
+        size_t filled = 0;
+        while (mylog::CallSiteRegistry::Register("fill.cpp", filled, mylog::LogLevel::value::DEBUG, "fill {}").id !=
+            mylog::CallSite::kUnregistered)
+            ++filled;
+        CHECK(filled > 0);
+        registered(1);
+        first_line = __LINE__ + 1;
+        MYLOG_INFO(logger, "overflow first {}", 1);
+        second_line = __LINE__ + 1;
+        MYLOG_WARN(logger, "overflow second {}", 2, mylog::KV("k", 3));
+    }
+    std::string text = ReadFile(path);
+    std::string file = "[behavior_test.cpp:";
+    CHECK(Lines(text).size() == 4);
+    CHECK(CountLines(text, "[ERROR][callsite_overflow]" + file + std::to_string(registered_line) + "]\tregistered ") == 2);
+    CHECK(CountLines(text, "[INFO][callsite_overflow]" + file + std::to_string(first_line) + "]\toverflow first 1") == 1);
+    CHECK(CountLines(text, "[WARN][callsite_overflow]" + file + std::to_string(second_line) + "]\toverflow second 2 k=3") == 1);
+    CHECK(CountLines(text, "fill") == 0);
+}
+
+int main()
+{
+    g_conf_data = mylog::Util::JsonData::GetJsonData();
+    tp = new ThreadPool(g_conf_data->thread_count);
+    // 死锁时整个测试挂住，超时直接失败退出
+    std::thread([]() {
+        std::this_thread::sleep_for(std::chrono::seconds(60));
+        cout << "behavior_test timed out" << endl;
+        _exit(2);
+    }).detach();
+
+    TestStagingShutdown();
+    TestMergeByTime();
+    TestLevelRouting();
+    TestSyncOnErrorLevels();
+    TestCoalescing();
+    TestRollHandlerOnShutdown();
+    TestRateLimit();
+    TestSharedLimitSite();
+    TestJsonLines();
+    TestStagedOverload();
+    TestRingFullSafe();
+    TestReserveCommit();
+    TestRuntimeLevel();
+    TestBackupSink();
+    TestCallSiteOverflow(); // 占满调用点表，放在最后
+
+    delete tp;
+    cout << (failures == 0 ? "all behavior tests passed" : "behavior tests failed") << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -29,6 +29,7 @@ int main() {
     Glb->BuildLoggerFlush<mylog::FileFlush>("./logfile/FileFlush.log");
     Glb->BuildLoggerFlush<mylog::RollFileFlush>("./logfile/RollFile_log",
                                               1024 * 1024);
+    Glb->BuildBackup(); // ERROR/FATAL日志发送到远程备份服务器
     //建造完成后，日志器已经建造，由LoggerManger类成员管理诸多日志器
     // 把日志器给管理对象，调用者通过调用单例管理对象对日志进行落地
     mylog::LoggerManager::GetInstance().AddLogger(Glb->Build());
@@ -1,84 +1,169 @@
 /*日志缓冲区类设计*/
 #pragma once
 #include <cassert>
+#include <cstring>
+#include <mutex>
 #include <string>
 #include <vector>
+#include <sys/uio.h> // 用于iovec
+#include "Level.hpp" // 缓冲区中日志等级的掩码
 #include "Util.hpp"
 
 extern mylog::Util::JsonData* g_conf_data;
 // 全局配置数据指针，指向JsonData单例对象
 namespace mylog{
-    class Buffer{
+    // Chunk：缓冲区的一个分段，大小固定为chunk_size，放不下的超长日志单独分配一个刚好够大的分段
+    struct Chunk {
+        char* data;      // 分段内存
+        size_t capacity; // 分段容量
+        size_t size;     // 已写入的字节数
+        size_t Writeable() const { return capacity - size; }
+    };
+
+    // ChunkPool：所有缓冲区共享的分段池，缓冲区重置时把分段还回池中，下次写入时复用
+    // 池中空闲分段的总大小超过chunk_pool_max后直接释放，峰值过后内存会还给系统
+    class ChunkPool {
     public:
-        Buffer() : write_pos_(0), read_pos_(0) {
-			buffer_.resize(g_conf_data->buffer_size); // 初始化缓冲区大小
+        static ChunkPool& GetInstance() {
+            static ChunkPool* pool = new ChunkPool; // 不析构，保证退出时其他静态对象仍可归还分段
+            return *pool;
+        }
+
+        size_t ChunkSize() const { return chunk_size_; }
+
+        // Get：取一个至少能写入len字节的分段
+        Chunk* Get(size_t len) {
+            if (len <= chunk_size_) {
+                std::unique_lock<std::mutex> lock(mtx_);
+                if (!free_.empty()) {
+                    Chunk* c = free_.back();
+                    free_.pop_back();
+                    c->size = 0;
+                    return c;
+                }
+            }
+            size_t cap = len > chunk_size_ ? len : chunk_size_;
+            return new Chunk{new char[cap], cap, 0};
         }
 
+        // Put：归还分段，超长分段和超出上限的分段直接释放
+        void Put(Chunk* c) {
+            if (c->capacity == chunk_size_) {
+                std::unique_lock<std::mutex> lock(mtx_);
+                if ((free_.size() + 1) * chunk_size_ <= max_free_) {
+                    free_.push_back(c);
+                    return;
+                }
+            }
+            delete[] c->data;
+            delete c;
+        }
+
+    private:
+        ChunkPool()
+            : chunk_size_(g_conf_data->chunk_size ? g_conf_data->chunk_size : 1024 * 1024),
+            max_free_(g_conf_data->chunk_pool_max) {}
+
+    private:
+        size_t chunk_size_;         // 普通分段的大小
+        size_t max_free_;           // 池中空闲分段的总字节数上限
+        std::mutex mtx_;            // 保护free_
+        std::vector<Chunk*> free_;  // 空闲分段
+    };
+
+    // Buffer：由若干分段组成的缓冲区，写入时从不移动已有数据
+    // 一次Push的数据总是写在同一个分段中，所以每个分段都只包含完整的日志，可以逐段解析
+    class Buffer{
+    public:
+        Buffer() : size_(0), levels_(0) {}
+        ~Buffer() { Reset(); }
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
         void Push(const char *data, size_t len)
         {
-            ToBeEnough(len); // 确保容量足够
-            // 开始写入
-			std::copy(data, data + len, &buffer_[write_pos_]); // 将数据从data复制到缓冲区的写入位置
-			write_pos_ += len; // 更新写入位置
+            if (len == 0)
+                return;
+            memcpy(Reserve(len), data, len); // 将数据复制到最后一个分段的末尾，放不下时换一个新分段
+            Commit(len);
+        }
+
+        // Reserve：保证最后一个分段还能连续写入len字节，返回写入位置
+        // 可以直接写入返回的位置再Commit，也可以之后分几次Push，这len字节都会落在同一个分段中
+        char* Reserve(size_t len)
+        {
+            if (chunks_.empty() || chunks_.back()->Writeable() < len)
+                chunks_.push_back(ChunkPool::GetInstance().Get(len));
+            return chunks_.back()->data + chunks_.back()->size;
         }
-        char *ReadBegin(int len)
+
+        // Commit：确认在Reserve返回的位置写入了len字节，len不能超过预留的大小
+        void Commit(size_t len)
         {
-			assert(len <= ReadableSize()); // 确保读取长度不超过可读数据大小
-			return &buffer_[read_pos_]; // 返回可读数据的起始位置
+            assert(!chunks_.empty() && len <= chunks_.back()->Writeable());
+            chunks_.back()->size += len;
+            size_ += len;
         }
-		bool IsEmpty() { return write_pos_ == read_pos_; }// 判断缓冲区是否为空
+
+		bool IsEmpty() const { return size_ == 0; }// 判断缓冲区是否为空
 
         void Swap(Buffer &buf)
         {
-			buffer_.swap(buf.buffer_); // 交换缓冲区内容
-			std::swap(read_pos_, buf.read_pos_); // 交换读位置
-			std::swap(write_pos_, buf.write_pos_); // 交换写位置
-        }
-        size_t WriteableSize()
-        { // 写空间剩余容量
-            return buffer_.size() - write_pos_;
+			chunks_.swap(buf.chunks_); // 交换分段列表
+			std::swap(size_, buf.size_); // 交换数据大小
+            std::swap(levels_, buf.levels_); // 交换等级掩码
         }
-        size_t ReadableSize()
-        { // 读空间剩余容量
-			return write_pos_ - read_pos_; // 计算可读数据大小
-        }
-		const char* Begin() { return &buffer_[read_pos_]; } // 获取可读数据的起始位置
-        void MoveWritePos(int len)
+
+        // Append：把buf的分段整体移到本缓冲区末尾，不拷贝数据，buf变为空
+        void Append(Buffer& buf)
         {
-			assert(len <= WriteableSize()); // 确保写入长度不超过可写数据大小
-			write_pos_ += len; // 更新写入位置
+            chunks_.insert(chunks_.end(), buf.chunks_.begin(), buf.chunks_.end());
+            size_ += buf.size_;
+            levels_ |= buf.levels_;
+            buf.chunks_.clear();
+            buf.size_ = 0;
+            buf.levels_ = 0;
         }
-        void MoveReadPos(int len)
-        {
-            assert(len <= ReadableSize());
-            read_pos_ += len;
+
+        // 缓冲区中日志等级的掩码（见LogLevel::Bit），由写入方在写入日志时标记，消费者据此判断这批日志是否要立即同步
+        void AddLevels(uint32_t levels) { levels_ |= levels; }
+        uint32_t Levels() const { return levels_; }
+
+        size_t WriteableSize() const
+        { // ASYNC_SAFE下生产者缓冲区的剩余容量，总容量为配置中的buffer_size
+            return size_ >= g_conf_data->buffer_size ? 0 : g_conf_data->buffer_size - size_;
         }
-        void Reset()
-        { // 重置缓冲区
-            write_pos_ = 0;
-            read_pos_ = 0;
+        size_t ReadableSize() const
+        { // 可读数据大小
+			return size_;
         }
 
-    protected:
-		void ToBeEnough(size_t len) // 确保缓冲区容量足够
+        // 分段数量及第i个分段的数据
+        size_t ChunkCount() const { return chunks_.size(); }
+        const char* ChunkData(size_t i) const { return chunks_[i]->data; }
+        size_t ChunkSize(size_t i) const { return chunks_[i]->size; }
+
+        // ToIovec：把所有非空分段填入iov，交给刷新器一次写入
+        void ToIovec(std::vector<struct iovec>& iov) const
         {
-            int buffersize = buffer_.size();
-			if (len >= WriteableSize()) // 如果需要写入的数据长度超过可写空间
-            {
-                if (buffer_.size() < g_conf_data->threshold) // 如果缓冲区小于阈值
-                {
-					buffer_.resize(2 * buffer_.size() + buffersize); // 扩大缓冲区大小
-                }
-                else
-                {
-					buffer_.resize(g_conf_data->linear_growth + buffersize); // 线性增长缓冲区大小
-                }
-            }
+            iov.clear();
+            for (auto c : chunks_)
+                if (c->size > 0)
+                    iov.push_back(iovec{c->data, c->size});
+        }
+
+        void Reset()
+        { // 重置缓冲区，分段还回分段池
+            for (auto c : chunks_)
+                ChunkPool::GetInstance().Put(c);
+            chunks_.clear();
+            size_ = 0;
+            levels_ = 0;
         }
 
     protected:
-        std::vector<char> buffer_; // 缓冲区
-        size_t write_pos_;         // 生产者此时的位置
-        size_t read_pos_;          // 消费者此时的位置
+        std::vector<Chunk*> chunks_; // 分段列表
+        size_t size_;                // 所有分段中的数据总量
+        uint32_t levels_;            // 所有分段中日志等级的掩码
     };
-} // namespace mylog
\ No newline at end of file
+} // namespace mylog
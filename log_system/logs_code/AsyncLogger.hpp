@@ -1,180 +1,755 @@
 #pragma once
+#include <algorithm> // 用于std::max
 #include <atomic> // 用于原子操作，如stop标志
 #include <cassert> // 用于断言
 #include <cstdarg> // 用于处理可变参数列表，如printf风格的格式化
+#include <functional> // 用于分片刷新器的创建函数
 #include <memory> // 用于智能指针std::shared_ptr
 #include <mutex> // 用于互斥锁
+#include <map> // 用于保存各刷新器的设置
+#include <unordered_map> // 用于Build时去重格式串
+#include <vector> // 用于保存异步工作器分片
 
 #include "Level.hpp" // 日志级别定义
 #include "AsyncWorker.hpp" // 异步工作器
+#include "StagingBuffer.hpp" // 线程本地暂存区
+#include "BinaryLog.hpp" // 延迟格式化的二进制记录
+#include "Coalescer.hpp" // 重复日志折叠
+#include "RateLimit.hpp" // 调用点限流与采样
+#include "Clock.hpp" // 日志时间戳
 #include "Message.hpp" // 日志消息结构
+#include "Pattern.hpp" // 日志输出格式
+#include "Format.hpp" // 类型安全的格式化
 #include "LogFlush.hpp" // 日志刷新器基类及派生类
-#include "backlog/CliBackupLog.hpp" // 客户端日志备份逻辑，用于远程备份
-#include "ThreadPoll.hpp" // 线程池，用于执行异步备份任务
+#include "SinkQueue.hpp" // 刷新器独立的队列和写入线程
+#include "backlog/CliBackupLog.hpp" // 远程备份发送端
+#include "ThreadPoll.hpp" // 线程池，由应用程序创建使用
 
 // 声明外部全局线程池指针
 extern ThreadPool* tp;
 
 namespace mylog
 {
+    // 日志器的可选配置，由LoggerBuilder填写
+    struct LoggerOptions {
+        BufferType buffer_type = BufferType::DOUBLE_BUFFER; // 缓冲区实现方式，默认双缓冲区
+        WaitPolicy wait_policy; // 消费者等待策略，默认自旋后挂起、有数据立即唤醒
+        StagingPolicy staging; // 线程暂存策略，默认不启用
+        bool deferred_format = false; // 是否延迟格式化：生产者只拷贝参数，由消费者线程格式化
+        LogLevel::value min_level = LogLevel::value::DEBUG; // 最低输出等级，运行时可通过SetLevel修改
+        size_t shards = 1; // 异步工作器分片数，每个分片有自己的缓冲区和消费者线程
+        OverloadPolicy overload; // ASYNC_UNSAFE下的过载策略，内存上限由各分片平分
+        std::vector<std::function<LogFlush::ptr(size_t)>> shard_flushs; // 每个分片独占的刷新器的创建函数，参数为分片序号
+        Pattern::ptr pattern; // 日志器的输出格式，为空时使用默认格式
+        SinkQueuePolicy sink_queue; // 刷新器独立队列，默认不启用
+        std::chrono::milliseconds coalesce_window{0}; // 重复日志折叠窗口，0表示不折叠
+    };
+
+    // SinkGroup：一组刷新器及其落地前的处理，只在消费者线程中使用
+    // 按时间戳合并时先合并，延迟格式化时再按各刷新器的格式还原为文本，最后交给每个刷新器
+    // 启用刷新器队列时，每个刷新器在自己的线程中写入，这里只把共享的数据放入各自的队列
+    class SinkGroup
+    {
+    public:
+        SinkGroup(std::vector<LogFlush::ptr> flushs, const LoggerOptions& options, const std::string& logger_name)
+            : flushs_(std::move(flushs)), logger_name_(logger_name),
+            pattern_(options.pattern ? options.pattern : Pattern::Default())
+        {
+            if (options.deferred_format)
+                renderer_.reset(new RecordRenderer(logger_name));
+            if (options.deferred_format && options.coalesce_window.count() > 0)
+                coalescer_.reset(new RecordCoalescer(options.coalesce_window, logger_name));
+            if (options.staging.enable && options.staging.merge_by_time)
+                merger_.reset(new RecordMerger());
+            // 格式和等级掩码都相同的刷新器共用一份文本，每种输出每批只还原一次
+            // 需要原始记录的刷新器共用一份原始输出，按它们等级掩码的并集过滤
+            for (auto& e : flushs_) {
+                queues_.push_back(options.sink_queue.enable
+                    ? std::make_shared<SinkQueue>(e, options.sink_queue, logger_name, pattern_) : nullptr);
+                urgent_levels_.push_back(e->GetSyncPolicy().UrgentLevels() & e->GetLevelMask());
+                if (e->NeedRaw()) {
+                    need_raw_ = true;
+                    raw_levels_ |= e->GetLevelMask();
+                    route_of_.push_back(0);
+                    continue;
+                }
+                const Pattern::ptr& pattern = e->GetPattern() ? e->GetPattern() : pattern_;
+                size_t i = 0;
+                while (i < routes_.size() && (routes_[i].pattern != pattern || routes_[i].levels != e->GetLevelMask()))
+                    ++i;
+                if (i == routes_.size())
+                    routes_.push_back(Route{pattern, e->GetLevelMask(), std::string(), nullptr});
+                route_of_.push_back(i);
+            }
+        }
+
+        bool Empty() const { return flushs_.empty(); }
+
+        // Deliver方法：把消费者取到的一批日志交给所有刷新器，刷新器实际写入的日志中有它的持久化策略要求立即同步的等级时，
+        // 写入后立即同步磁盘（见SyncPolicy::UrgentLevels），等级来自写入方在缓冲区上标记的掩码
+        // 每个分段都只包含完整的记录，合并和还原逐段进行；不需要处理时把所有分段作为iovec一次交给刷新器
+        // batch是启用刷新器队列时buffer的引用计数版本，由各刷新器的队列共享
+        // watermark是合并水位线（见StagingArea::Collect），早于它的日志都已交出，只在merge_by_time时使用
+        void Deliver(const Buffer& buffer, const std::shared_ptr<const Buffer>& batch, uint64_t watermark = UINT64_MAX)
+        {
+            if (flushs_.empty())
+                return;
+            uint32_t levels = buffer.Levels(); // 这批写入的日志等级
+            if (merger_)
+            {
+                // 按时间戳合并各线程日志，只输出早于水位线的，其他线程不会再交出更早的日志
+                for (size_t i = 0; i < buffer.ChunkCount(); ++i)
+                    merger_->Hold(buffer.ChunkData(i), buffer.ChunkSize(i));
+                merged_.clear();
+                levels = merger_->Merge(nullptr, 0, merged_, watermark); // 留到下一轮的日志这一轮不算写入
+                Render(merged_.data(), merged_.size(), levels);
+            } else if (renderer_) {
+                ClearRendered();
+                if (coalescer_) {
+                    coalesced_.clear();
+                    for (size_t i = 0; i < buffer.ChunkCount(); ++i)
+                        coalescer_->Filter(buffer.ChunkData(i), buffer.ChunkSize(i), coalesced_);
+                    coalescer_->Expire(coalesced_);
+                    RenderRoutes(coalesced_.data(), coalesced_.size());
+                } else {
+                    for (size_t i = 0; i < buffer.ChunkCount(); ++i)
+                        RenderRoutes(buffer.ChunkData(i), buffer.ChunkSize(i));
+                }
+                FlushRendered(levels);
+            } else if (!buffer.IsEmpty()) {
+                buffer.ToIovec(iov_);
+                for (size_t i = 0; i < flushs_.size(); ++i) {
+                    if (queues_[i])
+                        queues_[i]->Push(batch, nullptr, Urgent(i, levels));
+                    else
+                        flushs_[i]->FlushV(iov_.data(), (int)iov_.size());
+                }
+            }
+            for (size_t i = 0; i < flushs_.size(); ++i)
+                if (!queues_[i]) // 有队列的刷新器由写入线程在写完这批数据后同步
+                    flushs_[i]->Sync(Urgent(i, levels));
+        }
+
+        // Notice方法：输出一条由消费者线程生成的WARN日志，不参与合并，延迟格式化时包装为MESSAGE记录
+        void Notice(const std::string& payload)
+        {
+            if (flushs_.empty())
+                return;
+            notice_.clear();
+            if (renderer_)
+                EncodeMessage(notice_, LogLevel::value::WARN, __FILE__, __LINE__, logger_name_, payload.data(), payload.size());
+            else
+                pattern_->FormatTo(notice_, LogFields{Clock::NowNs(), LogLevel::value::WARN, __FILE__, __LINE__,
+                    logger_name_, LogMessage::ThreadIdString(), payload});
+            Render(notice_.data(), notice_.size(), LogLevel::Bit(LogLevel::value::WARN));
+        }
+
+        // Drain方法：日志器析构时输出水位线之后还没来得及输出的日志，此时消费者线程都已退出
+        // 折叠中的重复日志也在这里补上重复次数
+        void Drain()
+        {
+            if (merger_ && merger_->HasHeld()) {
+                merged_.clear();
+                uint32_t levels = merger_->Merge(nullptr, 0, merged_, UINT64_MAX);
+                Render(merged_.data(), merged_.size(), levels);
+            }
+            if (coalescer_)
+                Expire(true);
+        }
+
+        // Expire方法：消费者线程空闲时补上折叠窗口已结束的重复次数，避免故障结束后提示迟迟不输出
+        void Expire(bool all = false)
+        {
+            if (!coalescer_)
+                return;
+            coalesced_.clear();
+            coalescer_->Expire(coalesced_, all);
+            if (coalesced_.empty())
+                return;
+            ClearRendered();
+            RenderRoutes(coalesced_.data(), coalesced_.size());
+            FlushRendered(0); // 重复次数提示不要求立即同步
+        }
+
+        // Sync方法：按持久化策略同步各刷新器尚未落盘的数据，force为true时立即同步
+        // 有队列的刷新器空闲时由写入线程自己检查，只有立即同步时才放入一个同步请求
+        void Sync(bool force)
+        {
+            for (size_t i = 0; i < flushs_.size(); ++i) {
+                if (!queues_[i])
+                    flushs_[i]->Sync(force);
+                else if (force)
+                    queues_[i]->Push(nullptr, nullptr, true);
+            }
+        }
+
+        // 是否有刷新器要求ERROR/FATAL日志写入后立即同步
+        bool SyncOnError() const
+        {
+            for (auto& e : flushs_) {
+                SyncPolicy policy = e->GetSyncPolicy();
+                if (policy.Durable() && policy.sync_on_error)
+                    return true;
+            }
+            return false;
+        }
+
+        // 各刷新器中按时间分组同步的最短间隔，没有时返回0
+        std::chrono::milliseconds SyncInterval() const
+        {
+            std::chrono::milliseconds interval{0};
+            for (auto& e : flushs_) {
+                SyncPolicy policy = e->GetSyncPolicy();
+                if (policy.Grouped() && policy.interval.count() > 0 && (interval.count() == 0 || policy.interval < interval))
+                    interval = policy.interval;
+            }
+            return interval;
+        }
+
+    private:
+        // Render方法：延迟格式化时先按每种格式把记录还原为文本，再交给刷新器；否则数据已是文本，直接交给所有刷新器
+        // levels是这段数据中日志等级的掩码，决定有队列的刷新器写完后是否立即同步
+        void Render(const char* data, size_t len, uint32_t levels)
+        {
+            if (len == 0) // 没有数据则不做任何操作
+                return;
+            if (!renderer_) {
+                std::shared_ptr<const std::string> text; // 有队列的刷新器共享一份拷贝
+                for (size_t i = 0; i < flushs_.size(); ++i) { // 遍历所有注册的刷新器，将缓冲区内容刷新到各自的输出目标
+                    if (!queues_[i]) {
+                        flushs_[i]->Flush(data, len);
+                        continue;
+                    }
+                    if (!text)
+                        text = std::make_shared<std::string>(data, len);
+                    queues_[i]->Push(nullptr, text, Urgent(i, levels));
+                }
+                return;
+            }
+            ClearRendered();
+            if (coalescer_) {
+                coalesced_.clear();
+                coalescer_->Filter(data, len, coalesced_);
+                coalescer_->Expire(coalesced_);
+                RenderRoutes(coalesced_.data(), coalesced_.size());
+            } else {
+                RenderRoutes(data, len);
+            }
+            FlushRendered(levels);
+        }
+
+        // 第i个刷新器写入等级掩码为levels的日志后是否要立即同步，刷新器不接收的等级不算
+        bool Urgent(size_t i, uint32_t levels) const { return (levels & urgent_levels_[i]) != 0; }
+
+        void ClearRendered()
+        {
+            for (auto& r : routes_)
+                r.text.clear();
+            raw_.clear();
+        }
+
+        // RenderRoutes方法：按每种输出的格式和等级掩码把记录还原为文本，每条记录只还原到接收它的输出中
+        void RenderRoutes(const char* data, size_t len)
+        {
+            for (auto& r : routes_)
+                renderer_->Render(data, len, r.text, *r.pattern, r.levels);
+            if (need_raw_)
+                renderer_->Raw(data, len, raw_, raw_levels_);
+        }
+
+        // FlushRendered方法：每个刷新器拿到自己那种输出的文本，需要原始记录的刷新器拿到raw_
+        // 有队列的刷新器共享同一份文本，先写没有队列的刷新器，再把每种格式的文本移交一次，不拷贝
+        void FlushRendered(uint32_t levels)
+        {
+            for (size_t i = 0; i < flushs_.size(); ++i)
+            {
+                const std::string& data = flushs_[i]->NeedRaw() ? raw_ : routes_[route_of_[i]].text;
+                if (!queues_[i] && !data.empty())
+                    flushs_[i]->Flush(data.data(), data.size());
+            }
+            std::shared_ptr<const std::string> raw;
+            for (size_t i = 0; i < flushs_.size(); ++i)
+            {
+                if (!queues_[i])
+                    continue;
+                bool need_raw = flushs_[i]->NeedRaw();
+                std::string& data = need_raw ? raw_ : routes_[route_of_[i]].text;
+                std::shared_ptr<const std::string>& text = need_raw ? raw : routes_[route_of_[i]].shared;
+                if (!text)
+                    text = std::make_shared<std::string>(std::move(data));
+                queues_[i]->Push(nullptr, text, Urgent(i, levels));
+            }
+            for (auto& r : routes_)
+                r.shared.reset();
+        }
+
+    private:
+        std::vector<LogFlush::ptr> flushs_; // 日志刷新器列表，定义了日志的输出方式
+        std::string logger_name_; // 日志器名称，用于Notice
+        Pattern::ptr pattern_; // 日志器的输出格式
+        // 一种输出：格式和等级掩码
+        struct Route {
+            Pattern::ptr pattern; // 输出格式
+            uint32_t levels; // 接收的等级
+            std::string text; // 本批还原后的文本
+            std::shared_ptr<const std::string> shared; // 移交给刷新器队列的文本，只在FlushRendered中使用
+        };
+        std::vector<Route> routes_; // 各刷新器用到的不同输出
+        std::vector<size_t> route_of_; // 每个刷新器的输出在routes_中的序号，需要原始记录的刷新器不使用
+        uint32_t raw_levels_ = 0; // 需要原始记录的刷新器接收的等级
+        std::unique_ptr<RecordMerger> merger_; // 按时间戳合并日志，仅merge_by_time时创建
+        std::string merged_; // 合并后待落地的日志
+        std::unique_ptr<RecordRenderer> renderer_; // 还原二进制记录，仅延迟格式化时创建
+        std::unique_ptr<RecordCoalescer> coalescer_; // 折叠重复日志，仅设置了折叠窗口时创建
+        std::string coalesced_; // 折叠后待还原的记录
+        bool need_raw_ = false; // 是否有刷新器需要原始记录
+        std::string raw_; // 交给原始记录刷新器的数据
+        std::string notice_; // Notice包装成的文本记录
+        std::vector<struct iovec> iov_; // 缓冲区各分段的iovec，复用内存
+        std::vector<SinkQueue::ptr> queues_; // 每个刷新器的队列，未启用时为空指针
+        std::vector<uint32_t> urgent_levels_; // 每个刷新器写入后要立即同步的等级，见SyncPolicy::UrgentLevels
+    };
+
     // AsyncLogger类是异步日志记录器的核心实现
+    // shards大于1时有多个异步工作器分片，每个生产者线程固定写入其中一个分片，同一线程的日志顺序不变
+    // 分片独占的刷新器只由该分片的消费者线程写入，互不等待；共享的刷新器由各分片加锁轮流写入，
+    // 按批次交错，启用merge_by_time时由共享的合并器按时间戳合并各分片的日志
     class AsyncLogger
     {
     public:
         using ptr = std::shared_ptr<AsyncLogger>; // 定义智能指针类型
+        static constexpr std::chrono::milliseconds kSuppressReportInterval{1000}; // 报告限流条数的最短间隔
 
         // 构造函数：初始化日志器名称、刷新器列表和异步工作器
-        AsyncLogger(const std::string& logger_name, std::vector<LogFlush::ptr>& flushs, AsyncType type)
+        AsyncLogger(const std::string& logger_name, std::vector<LogFlush::ptr>& flushs, AsyncType type,
+            const LoggerOptions& options = LoggerOptions())
             : logger_name_(logger_name), // 初始化日志器名称
-            flushs_(flushs.begin(), flushs.end()), // 拷贝日志刷新器列表
-            // 启动异步工作器，绑定RealFlush方法作为回调，并指定异步类型
-            asyncworker(std::make_shared<AsyncWorker>(
-                std::bind(&AsyncLogger::RealFlush, this, std::placeholders::_1),
-                type)) {}
+            options_(options), // 可选配置
+            min_level_((int)options.min_level), // 最低输出等级
+            pattern_(options.pattern ? options.pattern : Pattern::Default()), // 输出格式
+            shared_(std::vector<LogFlush::ptr>(flushs.begin(), flushs.end()), options, logger_name) // 所有分片共享的刷新器
+        {
+            Clock::SetPrecision(g_conf_data->time_precision); // 日志时间的小数位数是全局的，按配置设置
+            // 持久化策略属于各个刷新器，任何一个刷新器要求时ERROR/FATAL都计数
+            sync_on_error_ = shared_.SyncOnError();
+            size_t count = options_.shards ? options_.shards : 1;
+            OverloadPolicy overload = options_.overload; // 日志器的内存上限由各分片平分
+            overload.max_bytes = std::max<size_t>(1, (overload.max_bytes ? overload.max_bytes : g_conf_data->unsafe_max_buffer) / count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                std::vector<LogFlush::ptr> own;
+                for (auto& create : options_.shard_flushs)
+                    own.push_back(create(i));
+                Shard* shard = new Shard(std::move(own), options_, logger_name_);
+                shards_.emplace_back(shard);
+                sync_on_error_ = sync_on_error_ || shard->sinks.SyncOnError();
+                // 启动异步工作器，绑定RealFlush方法作为回调，并指定异步类型和缓冲区实现方式
+                shard->worker = std::make_shared<AsyncWorker>(
+                    std::bind(&AsyncLogger::RealFlush, this, shard, std::placeholders::_1),
+                    type, options_.buffer_type, ConsumerWaitPolicy(options_), overload);
+                if (options_.staging.enable) {
+                    shard->staging = std::make_shared<StagingArea>(shard->worker, options_.staging);
+                    // 消费者线程每轮收取空闲线程暂存区中滞留过久的日志
+                    StagingArea::ptr staging_area = shard->staging;
+                    AsyncWorker* worker = shard->worker.get(); // 收取函数由工作器自己持有，使用裸指针避免循环引用
+                    // 同时记下本轮的合并水位线，交换缓冲区之前取得，这一轮之后交出的日志都不会早于它
+                    shard->worker->SetCollector([staging_area, worker, shard]() { shard->collected = staging_area->Collect(*worker); });
+                }
+                // 按时间分组同步磁盘时，消费者空闲的轮次也要检查是否该同步，避免最后一批日志迟迟不落盘
+                // 折叠重复日志时，空闲的轮次也要补上窗口已结束的重复次数
+                // 都不需要时消费者空闲时不定时醒来；限流的调用点出现后第一个分片再加上报告被拦下条数的间隔
+                for (auto interval : {shared_.SyncInterval(), shard->sinks.SyncInterval(), options_.coalesce_window})
+                    if (interval.count() > 0 && (shard->idle.count() == 0 || interval < shard->idle))
+                        shard->idle = interval;
+                std::chrono::milliseconds idle = shard->idle;
+                if (i == 0 && SiteLimiter::First() != nullptr) {
+                    suppress_tick_ = true;
+                    idle = ShorterInterval(idle, kSuppressReportInterval);
+                }
+                shard->worker->SetIdleHandler([this, shard]() { IdleSinks(*shard); }, idle);
+            }
+        }
 
-        virtual ~AsyncLogger() {}; // 虚析构函数，确保派生类资源正确释放
+        // 虚析构函数，确保派生类资源正确释放
+        virtual ~AsyncLogger()
+        {
+            for (auto& shard : shards_)
+            {
+                if (shard->staging)
+                    shard->staging->FlushAll(); // 交出所有线程暂存区中的日志
+                shard->worker->Stop(); // 停止工作线程，之后只有当前线程访问各个SinkGroup
+            }
+            ReportSuppressed(*shards_[0], true); // 最后一段时间被拦下的条数
+            for (auto& shard : shards_)
+                shard->sinks.Drain();
+            shared_.Drain();
+        }
 
         // 获取日志器名称
         std::string Name() { return logger_name_; }
 
+        // 设置最低输出等级，低于该等级的日志在格式化之前就被丢弃，可在运行时随时调用
+        void SetLevel(LogLevel::value level) { min_level_.store((int)level, std::memory_order_relaxed); }
+
+        // 获取最低输出等级
+        LogLevel::value GetLevel() const { return (LogLevel::value)min_level_.load(std::memory_order_relaxed); }
+
+        // 判断该等级的日志是否需要输出，只有一次原子读和一次比较，MYLOG_*宏在求值参数之前调用
+        bool ShouldLog(LogLevel::value level) const
+        {
+            return (int)level >= min_level_.load(std::memory_order_relaxed);
+        }
+
+        // 被MYLOG_MIN_LEVEL在编译期关闭的Debug/Info等宏展开为此空函数，参数不会求值
+        void Disabled() {}
+
+        // 获取异步工作器，用于查询唤醒次数、空取次数等运行统计
+        AsyncWorker::ptr Worker(size_t shard = 0) { return shards_[shard]->worker; }
+
+        // 异步工作器分片数
+        size_t ShardCount() const { return shards_.size(); }
+
+        // 过载丢弃的日志条数和字节数，所有分片之和（仅ASYNC_UNSAFE）
+        size_t DroppedCount() const
+        {
+            size_t n = 0;
+            for (auto& shard : shards_)
+                n += shard->worker->DroppedCount();
+            return n;
+        }
+        size_t DroppedBytes() const
+        {
+            size_t n = 0;
+            for (auto& shard : shards_)
+                n += shard->worker->DroppedBytes();
+            return n;
+        }
+
+        // 把当前线程暂存区中的日志立即交给异步工作器，线程即将长时间空闲时可主动调用
+        void FlushThreadBuffer()
+        {
+            Shard& shard = LocalShard();
+            if (shard.staging)
+                shard.staging->Local().Flush();
+        }
+
         // 以下是各种日志级别的记录方法 (Debug, Info, Warn, Error, Fatal)
         // 它们接收文件名、行号和printf风格的格式化字符串及可变参数
+        // format属性让编译器在编译期检查格式串与参数类型是否匹配(-Wformat)
 
-        void Debug(const std::string& file, size_t line, const std::string format, ...)
+        __attribute__((format(printf, 4, 5)))
+        void Debug(const char* file, size_t line, const char* format, ...)
         {
+            if (!ShouldLog(LogLevel::value::DEBUG)) // 等级不够直接返回，不做任何格式化
+                return;
             va_list va; // 可变参数列表
             va_start(va, format); // 初始化可变参数列表
-            char* ret;
-            // 将格式化字符串和可变参数打印到动态分配的字符串中
-            int r = vasprintf(&ret, format.c_str(), va);
-            if (r == -1)
-                perror("vasprintf failed!!!: ");
+            LogV(LogLevel::value::DEBUG, file, line, format, va); // 格式化后序列化并推送到异步缓冲区
             va_end(va); // 结束可变参数列表
-
-            // 将日志信息序列化并推送到异步缓冲区
-            serialize(LogLevel::value::DEBUG, file, line, ret);
-
-            free(ret); // 释放vasprintf分配的内存
-            ret = nullptr;
         };
 
         // Info级别日志记录方法 (类似Debug，只是日志级别不同)
-        void Info(const std::string& file, size_t line, const std::string format, ...)
+        __attribute__((format(printf, 4, 5)))
+        void Info(const char* file, size_t line, const char* format, ...)
         {
+            if (!ShouldLog(LogLevel::value::INFO))
+                return;
             va_list va;
             va_start(va, format);
-            char* ret;
-            int r = vasprintf(&ret, format.c_str(), va);
-            if (r == -1)
-                perror("vasprintf failed!!!: ");
+            LogV(LogLevel::value::INFO, file, line, format, va);
             va_end(va);
-
-            serialize(LogLevel::value::INFO, file, line, ret);
-
-            free(ret);
-            ret = nullptr;
         };
 
         // Warn级别日志记录方法
-        void Warn(const std::string& file, size_t line, const std::string format, ...)
+        __attribute__((format(printf, 4, 5)))
+        void Warn(const char* file, size_t line, const char* format, ...)
         {
+            if (!ShouldLog(LogLevel::value::WARN))
+                return;
             va_list va;
             va_start(va, format);
-            char* ret;
-            int r = vasprintf(&ret, format.c_str(), va);
-            if (r == -1)
-                perror("vasprintf failed!!!: ");
+            LogV(LogLevel::value::WARN, file, line, format, va);
             va_end(va);
-
-            serialize(LogLevel::value::WARN, file, line, ret);
-            free(ret);
-            ret = nullptr;
         };
 
         // Error级别日志记录方法
-        void Error(const std::string& file, size_t line, const std::string format, ...)
+        __attribute__((format(printf, 4, 5)))
+        void Error(const char* file, size_t line, const char* format, ...)
         {
+            if (!ShouldLog(LogLevel::value::ERROR))
+                return;
             va_list va;
             va_start(va, format);
-            char* ret;
-            int r = vasprintf(&ret, format.c_str(), va);
-            if (r == -1)
-                perror("vasprintf failed!!!: ");
+            LogV(LogLevel::value::ERROR, file, line, format, va);
             va_end(va);
-
-            serialize(LogLevel::value::ERROR, file, line, ret);
-
-            free(ret);
-            ret = nullptr;
         };
 
         // Fatal级别日志记录方法
-        void Fatal(const std::string& file, size_t line, const std::string format, ...)
+        __attribute__((format(printf, 4, 5)))
+        void Fatal(const char* file, size_t line, const char* format, ...)
         {
+            if (!ShouldLog(LogLevel::value::FATAL))
+                return;
             va_list va;
             va_start(va, format);
-            char* ret;
-            int r = vasprintf(&ret, format.c_str(), va);
-            if (r == -1)
-                perror("vasprintf failed!!!: ");
+            LogV(LogLevel::value::FATAL, file, line, format, va);
             va_end(va);
+        };
 
-            serialize(LogLevel::value::FATAL, file, line, ret);
+        // Log方法：类型安全的格式化接口，格式串使用{}占位，参数按实际类型格式化
+        // 通过MyLog.hpp中的MYLOG_INFO等宏调用时，占位符个数在编译期检查
+        template <typename... Args>
+        void Log(LogLevel::value level, const char* file, size_t line, const char* format, const Args&... args)
+        {
+            if (!ShouldLog(level))
+                return;
+            std::string& payload = PayloadScratch();
+            payload.clear();
+            fmt::FormatTo(payload, format, args...);
+            serialize(level, file, line, payload.data(), payload.size());
+        }
 
-            free(ret);
-            ret = nullptr;
-        };
+        // Log方法：调用点版本，由MYLOG_*宏调用，文件、行号和格式串来自登记过的调用点
+        // 等级由每次调用传入并写入记录头，同一调用点可以使用运行时决定的等级
+        // 延迟格式化时只把调用点id和参数原始字节写入缓冲区，格式化留给消费者线程，
+        // 结构化字段也保持类型，由消费者线程按各刷新器的格式输出为文本或JSON
+        template <typename... Args>
+        void Log(LogLevel::value level, const CallSite& site, const Args&... args)
+        {
+            if (!ShouldLog(level))
+                return;
+            if (!options_.deferred_format || site.id == CallSite::kUnregistered) { // 调用点表已满时立即格式化
+                Log(level, site.file, site.line, site.format, args...);
+                return;
+            }
+            std::string& data = RecordScratch();
+            data.clear();
+            EncodeRecord(data, site, level, args...);
+            Submit(data.data(), data.size(), level);
+        }
 
     protected:
+        // LogV方法：把printf风格的参数格式化到线程本地缓冲区，常见长度的日志不需要分配内存
+        void LogV(LogLevel::value level, const char* file, size_t line, const char* format, va_list va)
+        {
+            std::string& payload = PayloadScratch();
+            payload.resize(payload.capacity());
+            va_list copy;
+            va_copy(copy, va); // 缓冲区不够时需要再格式化一次
+            int r = vsnprintf(&payload[0], payload.size(), format, va);
+            if (r < 0) {
+                perror("vsnprintf failed!!!: ");
+                r = 0;
+            } else if ((size_t)r >= payload.size()) {
+                payload.resize(r + 1);
+                vsnprintf(&payload[0], payload.size(), format, copy);
+            }
+            va_end(copy);
+            serialize(level, file, line, payload.data(), r);
+        }
+
+        // 线程本地的信息体缓冲区，容量只增不减
+        static std::string& PayloadScratch()
+        {
+            thread_local std::string payload(1024, '\0');
+            return payload;
+        }
+
+        // 线程本地的整条日志缓冲区，容量只增不减
+        static std::string& RecordScratch()
+        {
+            thread_local std::string record;
+            return record;
+        }
+
         // serialize方法：组织日志消息，并进行必要的备份和推送到缓冲区
-        void serialize(LogLevel::value level, const std::string& file, size_t line, char* ret)
+        void serialize(LogLevel::value level, const char* file, size_t line, const char* payload, size_t len)
         {
-            LogMessage msg(level, file, line, logger_name_, ret); // 创建LogMessage对象
-            std::string data = msg.format(); // 格式化日志消息为字符串
+            // 在锁外格式化到线程本地缓冲区，不构造LogMessage和stringstream，之后只在加锁时拷贝一次
+            // 不直接格式化到生产者缓冲区：那样要持有工作器的锁做时间格式化，所有生产者都会在这里排队
+            // 延迟格式化的日志器只保存字段，由消费者线程按各刷新器的格式输出
+            std::string& data = RecordScratch();
+            data.clear();
+            if (options_.deferred_format)
+                EncodeMessage(data, level, file, line, logger_name_, payload, len);
+            else
+                pattern_->FormatTo(data, LogFields{Clock::NowNs(), level, file, line, logger_name_,
+                    LogMessage::ThreadIdString(), {payload, len}});
+            Submit(data.c_str(), data.size(), level);
+        }
 
-            // 如果是FATAL或ERROR级别的日志，则将其提交到线程池进行远程备份
-            if (level == LogLevel::value::FATAL || level == LogLevel::value::ERROR)
-            {
-                try
-                {
-                    // 使用线程池tp异步执行start_backup函数
-                    // start_backup是日志备份客户端的入口点
-                    auto backup_result_future = tp->enqueue(start_backup, data);
-                    backup_result_future.get(); // 阻塞等待备份任务完成（这里可能是为了确保备份的同步性，但异步通常不get()）
-                }
-                catch (const std::runtime_error& e)
-                {
-                    // 捕获线程池可能抛出的异常，例如线程池已停止
-                    std::cout << __FILE__ << __LINE__ << "thread pool closed" << std::endl;
-                }
+        // Submit方法：把一条格式化或编码好的日志推送到异步工作器的缓冲区
+        // 等级随日志一起交给消费者，消费者按每批实际写入的等级决定是否立即同步
+        void Submit(const char* data, size_t len, LogLevel::value level)
+        {
+            bool urgent = level == LogLevel::value::FATAL || level == LogLevel::value::ERROR;
+            Shard& shard = LocalShard();
+            Flush(data, len, level);
+            if (urgent && sync_on_error_ && shard.staging)
+                shard.staging->Local().Flush(); // 不在线程暂存区中滞留，尽快落盘
+        }
+
+        // Flush方法：将日志数据推送到当前线程所属分片的异步工作器（线程安全由AsyncWorker内部保证）
+        // 启用线程暂存时先写入当前线程的暂存区，攒够一批再交给异步工作器
+        void Flush(const char* data, size_t len, LogLevel::value level)
+        {
+            Shard& shard = LocalShard();
+            if (shard.staging)
+                shard.staging->Local().Append(data, len, level);
+            else
+                shard.worker->Push(data, len, level); // AsyncWorker的Push函数是线程安全的
+        }
+
+        // 一个异步工作器分片：工作器、线程暂存区、独占的刷新器，以及消费者线程判断是否立即同步的状态
+        struct Shard
+        {
+            Shard(std::vector<LogFlush::ptr> flushs, const LoggerOptions& options, const std::string& logger_name)
+                : sinks(std::move(flushs), options, logger_name) {}
+            AsyncWorker::ptr worker; // 异步工作器
+            StagingArea::ptr staging; // 线程暂存区，未启用时为空
+            SinkGroup sinks; // 本分片独占的刷新器，只有本分片的消费者线程访问
+            size_t reported_drops = 0; // 已经输出过提示的丢弃条数，只有消费者线程访问
+            size_t reported_bytes = 0; // 已经输出过提示的丢弃字节数，只有消费者线程访问
+            uint64_t collected = 0; // 本轮收取时的合并水位线，只有消费者线程访问
+            std::atomic<uint64_t> delivered{0}; // 已交给共享刷新器的日志对应的合并水位线，其他分片的消费者线程读取
+            std::chrono::milliseconds idle{0}; // 持久化策略和折叠窗口要求的空闲处理间隔，0表示不需要定时
+        };
+
+        // 当前线程所属的分片，线程第一次写日志时按顺序分配序号，分片数相同的日志器上同一线程总是落在同一分片
+        Shard& LocalShard()
+        {
+            if (shards_.size() == 1)
+                return *shards_[0];
+            static std::atomic<size_t> next_index{0};
+            thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+            return *shards_[index % shards_.size()];
+        }
+
+        // RealFlush方法：异步工作器回调函数，由该分片的消费者线程实际执行日志落地
+        // 先写本分片独占的刷新器，再加锁写共享的刷新器
+        void RealFlush(Shard* shard, Buffer& buffer)
+        {
+            // 启用刷新器队列时，把这批数据的分段整体移入一个引用计数的缓冲区，由各刷新器的队列共享，
+            // 最后一个写完的刷新器释放它时分段还回分段池；消费者线程不等待任何刷新器
+            std::shared_ptr<const Buffer> batch;
+            if (options_.sink_queue.enable) {
+                auto moved = std::make_shared<Buffer>();
+                moved->Append(buffer);
+                batch = std::move(moved);
+            }
+            const Buffer& data = batch ? *batch : buffer;
+            // 本分片独占的刷新器只有本分片的日志，按本轮的水位线合并；共享的刷新器还要等其他分片的水位线
+            shard->sinks.Deliver(data, batch, shard->collected);
+            if (!shared_.Empty()) {
+                uint64_t watermark = shard->collected;
+                for (auto& other : shards_)
+                    if (other.get() != shard)
+                        watermark = std::min(watermark, other->delivered.load(std::memory_order_acquire));
+                std::unique_lock<std::mutex> lock(mtx_);
+                shared_.Deliver(data, batch, watermark);
             }
-            // 将格式化后的日志数据推送到异步工作器的缓冲区
-            Flush(data.c_str(), data.size());
+            // 本轮取到的日志都已交给共享的合并器，其他分片可以按这个水位线输出
+            shard->delivered.store(shard->collected, std::memory_order_release);
+            ReportDrops(*shard);
+            ReportSuppressed(*shard);
         }
 
-        // Flush方法：将日志数据推送到异步工作器（线程安全由AsyncWorker内部保证）
-        void Flush(const char* data, size_t len)
+        // ReportDrops方法：上一次提示之后有日志因过载被丢弃时，在本批日志之后输出一条提示
+        void ReportDrops(Shard& shard)
         {
-            asyncworker->Push(data, len); // AsyncWorker的Push函数是线程安全的
+            size_t dropped = shard.worker->DroppedCount();
+            if (dropped == shard.reported_drops)
+                return;
+            size_t bytes = shard.worker->DroppedBytes();
+            std::string payload = std::to_string(dropped - shard.reported_drops) + " messages (" +
+                std::to_string(bytes - shard.reported_bytes) + " bytes) dropped due to overload";
+            shard.reported_drops = dropped;
+            shard.reported_bytes = bytes;
+            Notice(shard, payload);
         }
 
-        // RealFlush方法：异步工作器回调函数，由异步线程实际执行日志落地
-		// 遍历所有注册的日志刷新器，将缓冲区内容刷新到各自的输出目标
-        void RealFlush(Buffer& buffer)
+        // 两个空闲处理间隔中较短的一个，0表示不需要定时
+        static std::chrono::milliseconds ShorterInterval(std::chrono::milliseconds a, std::chrono::milliseconds b)
         {
-            if (flushs_.empty()) // 如果没有注册刷新器，则不做任何操作
+            if (a.count() == 0)
+                return b;
+            return b.count() == 0 || a < b ? a : b;
+        }
+
+        // ReportSuppressed方法：报告本日志器在限流的调用点被拦下的条数，每个调用点一条提示
+        // 只由第一个分片的消费者线程执行，最多每kSuppressReportInterval一次，force为true时立即报告（日志器析构时）
+        void ReportSuppressed(Shard& shard, bool force = false)
+        {
+            if (&shard != shards_[0].get())
+                return;
+            // 第一个限流的调用点在日志器创建之后才出现（调用点的限流器是静态局部变量，第一次执行时创建），
+            // 它第一次总是放行，这条日志落地时在这里开启定时报告
+            if (!suppress_tick_ && SiteLimiter::First() != nullptr) {
+                suppress_tick_ = true;
+                shard.worker->SetIdleInterval(ShorterInterval(shard.idle, kSuppressReportInterval));
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (!force && now - last_suppress_report_ < kSuppressReportInterval)
                 return;
-            for (auto& e : flushs_) // 遍历所有注册的刷新器，将缓冲区内容刷新到各自的输出目标
+            last_suppress_report_ = now;
+            for (SiteLimiter* site = SiteLimiter::First(); site; site = site->Next())
             {
-                e->Flush(buffer.Begin(), buffer.ReadableSize());
+                // force只在日志器析构时使用，同时让出本日志器占用的槽位
+                size_t suppressed = force ? site->Release(this) : site->TakeSuppressed(this);
+                if (suppressed > 0)
+                    Notice(shard, std::to_string(suppressed) + " messages suppressed by rate limit at " +
+                        site->File() + ":" + std::to_string(site->Line()));
+                size_t spilled = site->TakeSpilled();
+                if (spilled > 0)
+                    Notice(shard, std::to_string(spilled) + " messages suppressed by rate limit at " +
+                        site->File() + ":" + std::to_string(site->Line()) + " (logged through other loggers)");
+            }
+        }
+
+        // Notice方法：向该分片能写入的所有刷新器输出一条日志器自身的提示
+        void Notice(Shard& shard, const std::string& payload)
+        {
+            shard.sinks.Notice(payload);
+            if (!shared_.Empty()) {
+                std::unique_lock<std::mutex> lock(mtx_);
+                shared_.Notice(payload);
             }
         }
 
+        // IdleSinks方法：消费者线程空闲时补上已结束的重复次数和限流拦下的条数，并按持久化策略同步该分片能写入的刷新器
+        void IdleSinks(Shard& shard)
+        {
+            ReportSuppressed(shard);
+            shard.sinks.Expire();
+            shard.sinks.Sync(false);
+            if (!shared_.Empty()) {
+                std::unique_lock<std::mutex> lock(mtx_);
+                shared_.Expire();
+                shared_.Sync(false);
+            }
+        }
+
+        // 启用线程暂存时消费者必须定时醒来收取空闲线程的暂存数据
+        static WaitPolicy ConsumerWaitPolicy(const LoggerOptions& options)
+        {
+            WaitPolicy policy = options.wait_policy;
+            const StagingPolicy& staging = options.staging;
+            if (staging.enable && (policy.max_latency.count() == 0 || policy.max_latency > staging.max_delay))
+                policy.max_latency = staging.max_delay;
+            return policy;
+        }
+
     protected:
-        std::mutex mtx_; // 互斥锁，尽管Push操作由AsyncWorker内部处理线程安全，这里可能用于其他内部状态
+        std::mutex mtx_; // 互斥锁，保护共享的刷新器shared_，各分片的消费者线程轮流写入
         std::string logger_name_; // 日志器名称
-        std::vector<LogFlush::ptr> flushs_; // 日志刷新器列表，定义了日志的输出方式
-        mylog::AsyncWorker::ptr asyncworker; // 异步工作器实例
+        LoggerOptions options_; // 可选配置
+        std::atomic<int> min_level_; // 最低输出等级，生产者线程无锁读取
+        bool sync_on_error_ = false; // ERROR/FATAL是否立即同步磁盘
+        Pattern::ptr pattern_; // 输出格式，在LoggerBuilder::Build时解析好
+        std::chrono::steady_clock::time_point last_suppress_report_; // 上次报告限流条数的时间，只有第一个分片的消费者线程访问
+        bool suppress_tick_ = false; // 第一个分片的空闲处理是否已按kSuppressReportInterval定时，只有第一个分片的消费者线程访问
+        SinkGroup shared_; // 所有分片共享的刷新器
+        std::vector<std::unique_ptr<Shard>> shards_; // 异步工作器分片，至少一个
     };
 
     // LoggerBuilder类：用于构建和配置AsyncLogger实例（建造者模式）
@@ -189,12 +764,90 @@ namespace mylog
         // 设置异步模式类型
         void BuildLopperType(AsyncType type) { async_type_ = type; }
 
+        // 设置生产者缓冲区实现方式（双缓冲区/无锁环形缓冲区）
+        void BuildBufferType(BufferType type) { options_.buffer_type = type; }
+
+        // 设置消费者线程空闲时的等待策略（自旋次数、最长休眠时间）
+        void BuildWaitPolicy(const WaitPolicy& policy) { options_.wait_policy = policy; }
+
+        // 启用生产者线程本地暂存，日志先写入线程暂存区再批量交给异步工作器
+        void BuildStaging(const StagingPolicy& policy) { options_.staging = policy; options_.staging.enable = true; }
+
+        // 设置最低输出等级，低于该等级的日志不做格式化直接丢弃
+        void BuildLevel(LogLevel::value level) { options_.min_level = level; }
+
+        // 设置ASYNC_UNSAFE下的过载策略：内存上限和丢弃方式
+        void BuildOverloadPolicy(const OverloadPolicy& policy) { options_.overload = policy; }
+
+        // 启用刷新器独立队列：每个刷新器在自己的线程中写入，慢的刷新器只让自己的队列等待或丢弃
+        void BuildSinkQueue(const SinkQueuePolicy& policy) { options_.sink_queue = policy; options_.sink_queue.enable = true; }
+
+        // 启用延迟格式化：MYLOG_*宏写入的日志由消费者线程格式化，可配合BinaryFileFlush输出原始记录
+        void BuildDeferredFormat(bool enable = true) { options_.deferred_format = enable; }
+
         // 添加日志刷新方式（模板方法，支持多种刷新器）
         template <typename FlushType, typename... Args>
         void BuildLoggerFlush(Args &&...args)
         {
             // 使用LogFlushFactory创建指定类型的刷新器并添加到列表中
             flushs_.emplace_back( LogFlushFactory::CreateLog<FlushType>(std::forward<Args>(args)...));
+            last_is_shard_ = false;
+        }
+
+        // 设置日志器的输出格式，占位符见Pattern，例如"%T [%t][%l][%n][%s:%#] %v"，Pattern::kJson为每行一个JSON对象
+        void BuildPattern(const std::string& pattern) { pattern_ = pattern; }
+
+        // 为最近添加的一个刷新器（BuildLoggerFlush或BuildShardFlush）单独设置输出格式
+        // 有刷新器使用自己的格式时日志器自动启用延迟格式化，由消费者线程按各刷新器的格式输出
+        void BuildFlushPattern(const std::string& pattern) { LastFlushSettings().pattern = pattern; }
+
+        // 启用重复日志折叠：同一调用点在window内连续输出相同的内容时只输出一次，之后补一条重复次数
+        // 折叠依赖记录头中的调用点和时间，日志器自动启用延迟格式化
+        void BuildCoalesce(std::chrono::milliseconds window) { options_.coalesce_window = window; }
+
+        // 为最近添加的一个刷新器设置接收的等级掩码，例如LogLevel::Range(LogLevel::value::ERROR, LogLevel::value::FATAL)
+        // 有刷新器只接收部分等级时日志器自动启用延迟格式化，每条记录带着记录头中的等级，由消费者线程按等级路由
+        void BuildFlushLevels(uint32_t levels) { LastFlushSettings().levels = levels; }
+
+        // 为最近添加的一个刷新器单独设置持久化策略，覆盖配置文件中的flush_log/sync_interval/sync_bytes/sync_on_error
+        // 例如ERROR/FATAL文件每批fdatasync，旁边的DEBUG/INFO滚动文件只交给页缓存
+        void BuildFlushSync(const SyncPolicy& policy)
+        {
+            FlushSettings& s = LastFlushSettings();
+            s.sync = policy;
+            s.has_sync = true;
+        }
+
+        // 添加远程备份刷新器，只接收ERROR/FATAL，由消费者线程按批交给BackupClient发送，生产者线程不参与备份
+        void BuildBackup()
+        {
+            BuildLoggerFlush<BackupFlush>();
+            BuildFlushLevels(LogLevel::Range(LogLevel::value::ERROR, LogLevel::value::FATAL));
+        }
+
+        // 设置异步工作器分片数，每个分片有独立的缓冲区和消费者线程，生产者按线程分配到分片
+        void BuildShards(size_t shards) { options_.shards = shards; }
+
+        // 添加每个分片独占的刷新器（模板方法），每个分片创建一个，文件名中插入分片序号，
+        // 例如"./logfile/app.log"在分片1上为"./logfile/app.shard1.log"，各分片写各自的文件，互不加锁
+        template <typename FlushType, typename... Args>
+        void BuildShardFlush(const std::string& filename, Args... args)
+        {
+            options_.shard_flushs.emplace_back([=](size_t shard) {
+                return LogFlushFactory::CreateLog<FlushType>(ShardFilename(filename, shard), args...);
+            });
+            last_is_shard_ = true;
+        }
+
+        // 在文件扩展名之前插入分片序号，没有扩展名时追加在末尾
+        static std::string ShardFilename(const std::string& filename, size_t shard)
+        {
+            size_t slash = filename.find_last_of('/');
+            size_t dot = filename.find_last_of('.');
+            std::string tag = ".shard" + std::to_string(shard);
+            if (dot == std::string::npos || (slash != std::string::npos && dot < slash) || dot == slash + 1)
+                return filename + tag;
+            return filename.substr(0, dot) + tag + filename.substr(dot);
         }
 
         // 构建并返回一个配置好的AsyncLogger实例
@@ -203,17 +856,86 @@ namespace mylog
             assert(logger_name_.empty() == false); // 断言日志器名称不能为空
 
             // 如果没有指定日志刷新方式，则默认使用标准输出
-            if (flushs_.empty())
+            if (flushs_.empty() && options_.shard_flushs.empty())
                 flushs_.emplace_back(std::make_shared<StdoutFlush>());
 
+            // 输出格式在这里解析一次，相同的格式串共用一个Pattern
+            LoggerOptions options = options_;
+            std::unordered_map<std::string, Pattern::ptr> compiled;
+            auto compile = [&compiled](const std::string& str) {
+                Pattern::ptr& p = compiled[str];
+                if (!p)
+                    p = str == Pattern::kDefault ? Pattern::Default() : std::make_shared<Pattern>(str);
+                return p;
+            };
+            if (!pattern_.empty())
+                options.pattern = compile(pattern_);
+            // 刷新器各自的格式、等级掩码和持久化策略，有格式或等级掩码时需要消费者线程拿到带记录头的记录
+            bool need_records = false;
+            auto apply = [&](const FlushSettings& s, LogFlush& flush) {
+                if (!s.pattern.empty())
+                    flush.SetPattern(compile(s.pattern));
+                flush.SetLevelMask(s.levels);
+                if (s.has_sync)
+                    flush.SetSyncPolicy(s.sync);
+            };
+            for (auto& e : flush_settings_) {
+                apply(e.second, *flushs_[e.first]);
+                need_records = need_records || e.second.NeedRecords();
+            }
+            for (auto& e : shard_settings_) {
+                auto create = options.shard_flushs[e.first];
+                Pattern::ptr pattern = e.second.pattern.empty() ? nullptr : compile(e.second.pattern);
+                FlushSettings settings = e.second;
+                options.shard_flushs[e.first] = [create, pattern, settings](size_t shard) {
+                    LogFlush::ptr flush = create(shard);
+                    if (pattern)
+                        flush->SetPattern(pattern);
+                    flush->SetLevelMask(settings.levels);
+                    if (settings.has_sync)
+                        flush->SetSyncPolicy(settings.sync);
+                    return flush;
+                };
+                need_records = need_records || e.second.NeedRecords();
+            }
+            // 输出JSON时结构化字段要保持类型，由消费者线程还原，同样需要延迟格式化
+            if (need_records || options.coalesce_window.count() > 0 ||
+                (options.pattern && options.pattern->IsJson()))
+                options.deferred_format = true;
+
             // 创建并返回AsyncLogger实例
-            return std::make_shared<AsyncLogger>( logger_name_, flushs_, async_type_);
+            return std::make_shared<AsyncLogger>( logger_name_, flushs_, async_type_, options);
         }
 
     protected:
         std::string logger_name_ = "async_logger"; // 日志器名称，默认值为"async_logger"
         std::vector<mylog::LogFlush::ptr> flushs_; // 存储日志刷新方式
         AsyncType async_type_ = AsyncType::ASYNC_SAFE; // 异步模式类型，默认安全模式
+        LoggerOptions options_; // 其他可选配置
+        std::string pattern_; // 日志器的输出格式串，为空时使用默认格式
+        // 单个刷新器的设置，在Build时应用
+        struct FlushSettings {
+            std::string pattern; // 输出格式串，为空时使用日志器的格式
+            uint32_t levels = LogLevel::kAllLevels; // 接收的等级
+            bool has_sync = false; // 是否设置了持久化策略，否则使用配置文件中的策略
+            SyncPolicy sync; // 持久化策略
+            // 是否需要消费者线程按记录头中的等级和各刷新器的格式输出
+            bool NeedRecords() const { return !pattern.empty() || levels != LogLevel::kAllLevels; }
+        };
+        std::map<size_t, FlushSettings> flush_settings_; // flushs_中刷新器的序号及其设置
+        std::map<size_t, FlushSettings> shard_settings_; // shard_flushs中创建函数的序号及其设置
+        bool last_is_shard_ = false; // 最近添加的是否是分片刷新器
+
+        // 最近添加的刷新器的设置
+        FlushSettings& LastFlushSettings()
+        {
+            if (last_is_shard_) {
+                assert(!options_.shard_flushs.empty());
+                return shard_settings_[options_.shard_flushs.size() - 1];
+            }
+            assert(!flushs_.empty());
+            return flush_settings_[flushs_.size() - 1];
+        }
     };
 } // namespace mylog
 
@@ -221,6 +943,19 @@ namespace mylog
 // mylog::LoggerBuilder builder; // 创建LoggerBuilder实例
 // builder.BuildLoggerName("my_async_logger"); // 设置日志器名称
 // builder.BuildLopperType(mylog::AsyncType::ASYNC_SAFE); // 设置异步类型
+// builder.BuildBufferType(mylog::BufferType::RING_BUFFER); // 可选：使用无锁环形缓冲区
+// builder.BuildShards(4); // 可选：4个异步工作器分片
+// builder.BuildShardFlush<mylog::RawFileFlush>("./logfile/app.log", 64 * 1024 * 1024); // 可选：每个分片写自己的文件
+// builder.BuildPattern("%T [%t][%l][%n][%s:%#] %v"); // 可选：日志器的输出格式
 // builder.BuildLoggerFlush<mylog::FileFlush>("log.txt"); // 添加文件刷新器
+// builder.BuildFlushPattern("%T %l %v"); // 可选：上面的文件刷新器使用自己的输出格式
+// builder.BuildFlushLevels(mylog::LogLevel::Range(mylog::LogLevel::value::DEBUG, mylog::LogLevel::value::INFO)); // 可选：只接收DEBUG/INFO
+// builder.BuildFlushSync(mylog::SyncPolicy()); // 可选：上面的文件刷新器不同步磁盘，不受配置文件中flush_log的影响
+// builder.BuildLoggerFlush<mylog::FileFlush>("log.jsonl"); // 可选：供分析工具读取的JSON lines文件
+// builder.BuildFlushPattern(mylog::Pattern::kJson); // 每行一个JSON对象，mylog::KV字段作为对象的成员
+// builder.BuildBackup(); // 可选：ERROR/FATAL日志发送到远程备份服务器
+// builder.BuildSinkQueue(mylog::SinkQueuePolicy()); // 可选：每个刷新器有自己的队列和写入线程
+// builder.BuildCoalesce(std::chrono::milliseconds(1000)); // 可选：1秒内同一调用点的相同日志只输出一次
 // auto logger = builder.Build(); // 构建AsyncLogger实例
-// logger->Info(__FILE__, __LINE__, "This is an info log message with value: %d", 42); // 记录日志
\ No newline at end of file
+// logger->Info(__FILE__, __LINE__, "This is an info log message with value: %d", 42); // 记录日志
+// MYLOG_INFO(logger, "download done", mylog::KV("url", url), mylog::KV("bytes", len)); // 带结构化字段的日志
\ No newline at end of file
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <atomic> // 用于原子操作，如stop_标志
+#include <chrono> // 用于消费者的最长等待时间
 #include <condition_variable> // 用于线程间的条件等待和通知
+#include <cstring> // 用于memcpy
 #include <functional> // 用于std::function定义回调函数
 #include <iostream> // 标准输入输出
 #include <mutex> // 用于互斥锁
 #include <thread> // 用于创建异步工作线程
 #include "AsyncBuffer.hpp" // 包含Buffer类定义
+#include "RingBuffer.hpp" // 包含无锁环形缓冲区RingBuffer定义
+#include "Level.hpp" // 过载时按日志等级丢弃
 
 namespace mylog {
     // 定义异步操作类型：安全（阻塞）和不安全（非阻塞/可能丢弃）
@@ -14,6 +18,42 @@ namespace mylog {
     // ASYNC_UNSAFE：不安全模式。写入时如果缓冲区满了，可能直接丢弃日志，不阻塞生产者线程，追求性能但可能丢日志。
     enum class AsyncType { ASYNC_SAFE, ASYNC_UNSAFE };
 
+    // 定义生产者缓冲区的实现方式
+    // DOUBLE_BUFFER：双缓冲区交换，生产者写入时需要加锁
+    // RING_BUFFER：有界无锁环形缓冲区，生产者通过CAS抢占槽位，消费者批量取出
+    //              ASYNC_SAFE下满了会等待消费者腾出空间，ASYNC_UNSAFE下满了直接丢弃
+    enum class BufferType { DOUBLE_BUFFER, RING_BUFFER };
+
+    // 消费者线程空闲时的等待策略：先自旋spin_count次，仍没有数据再挂起到条件变量上
+    // max_latency为0时，生产者发现消费者挂起会立即唤醒它；
+    // max_latency大于0时，生产者不再主动唤醒，消费者最多休眠max_latency后自行醒来，
+    // 用日志最多延迟max_latency落地换取更少的唤醒系统调用（ASYNC_SAFE等待空间时仍会唤醒）
+    struct WaitPolicy {
+        size_t spin_count = 1000;                  // 挂起前的自旋次数
+        std::chrono::milliseconds max_latency{0};  // 消费者最长休眠时间，0表示不限
+    };
+
+    // ASYNC_UNSAFE下过载时的丢弃策略
+    // DROP_NEWEST：待消费数据达到上限后丢弃新日志
+    // DROP_LOWEST_LEVEL：等级越低允许占用的容量越少，DEBUG到一半、INFO到3/4、WARN到9/10就开始丢弃，ERROR/FATAL到上限才丢弃
+    // SAMPLE：超过一半容量后每sample_rate条只保留一条，达到上限后全部丢弃
+    enum class DropPolicy { DROP_NEWEST, DROP_LOWEST_LEVEL, SAMPLE };
+
+    // 过载策略：限制生产者缓冲区中待消费数据的字节数，内存占用不会无限增长（仅ASYNC_UNSAFE）
+    // 环形缓冲区本身有界，满了直接丢弃，只有放不进环形缓冲区的超长日志受此限制
+    struct OverloadPolicy {
+        size_t max_bytes = 0;                      // 待消费数据的上限，0表示使用配置文件中的unsafe_max_buffer
+        DropPolicy drop = DropPolicy::DROP_NEWEST; // 丢弃策略
+        size_t sample_rate = 10;                   // SAMPLE策略的采样间隔
+    };
+
+    // 线程暂存区交出的一批日志中的一条：在批次中的偏移、长度和等级，过载时按它逐条决定是否丢弃
+    struct BatchRecord {
+        uint32_t offset;
+        uint32_t len;
+        LogLevel::value level;
+    };
+
     // 定义回调函数类型，接受一个Buffer引用作为参数
     using functor = std::function<void(Buffer&)>;
 
@@ -23,69 +63,361 @@ namespace mylog {
         using ptr = std::shared_ptr<AsyncWorker>; // 定义智能指针类型
 
         // 构造函数：初始化异步类型、回调函数，并启动工作线程
-        AsyncWorker(const functor& cb, AsyncType async_type = AsyncType::ASYNC_SAFE)
+        AsyncWorker(const functor& cb, AsyncType async_type = AsyncType::ASYNC_SAFE,
+            BufferType buffer_type = BufferType::DOUBLE_BUFFER, WaitPolicy wait_policy = WaitPolicy(),
+            OverloadPolicy overload = OverloadPolicy())
             : async_type_(async_type), // 异步模式
-            callback_(cb),       // 日志落地回调函数
+            buffer_type_(buffer_type), // 缓冲区实现方式
+            wait_policy_(wait_policy), // 消费者等待策略
+            overload_(overload), // 过载策略
             stop_(false),        // 停止标志，初始为false
+            callback_(cb),       // 日志落地回调函数
             // 启动一个新线程，执行ThreadEntry方法作为工作线程
+            // 注意：thread_必须最后声明，保证线程启动时其他成员都已初始化完毕
             thread_(std::thread(&AsyncWorker::ThreadEntry, this)) {
+            if (overload_.max_bytes == 0)
+                overload_.max_bytes = g_conf_data->unsafe_max_buffer;
+            if (overload_.sample_rate == 0)
+                overload_.sample_rate = 1;
         }
 
         // 析构函数：停止工作线程，确保所有日志被处理
         ~AsyncWorker() { Stop(); }
 
-        // Push方法：生产者线程调用，将日志数据写入缓冲区
-        void Push(const char* data, size_t len) {
+        // Push方法：生产者线程调用，将日志数据写入缓冲区，level用于过载时按等级丢弃，并随数据交给消费者
+        void Push(const char* data, size_t len, LogLevel::value level = LogLevel::value::FATAL) {
+            // 环形缓冲区模式走无锁路径，超长日志放不进环形缓冲区时退回到加锁的双缓冲区
+            if (ring_ && len <= ring_->MaxRecordSize()) {
+                PushRing(data, len, LogLevel::Bit(level));
+                return;
+            }
             std::unique_lock<std::mutex> lock(mtx_); // 加锁保护生产者缓冲区
-            // 如果是ASYNC_SAFE模式，且生产者缓冲区空间不足，则等待
-            if (AsyncType::ASYNC_SAFE == async_type_) {
-                cond_productor_.wait(lock, [&](){ return len <= buffer_productor_.WriteableSize();});
-				//std::condition_variable::wait会自动释放锁，等待条件满足后再重新加锁，参数：(锁， 条件)
+            // ASYNC_UNSAFE模式按过载策略决定是否丢弃，缓冲区不会超过上限
+            if (AsyncType::ASYNC_UNSAFE == async_type_ && !Admit(len, level)) {
+                Drop(len);
+                return;
+            }
+            WaitForSpace(lock, len);
+            buffer_productor_.Push(data, len);
+            buffer_productor_.AddLevels(LogLevel::Bit(level));
+            Publish();
+        }
+
+        // PushBatch方法：写入线程暂存区攒下的一批日志，records是批次中每条日志的位置和等级
+        // ASYNC_UNSAFE下整批都在各自等级的容量内时一次拷贝，否则按过载策略逐条决定，丢弃条数按实际的日志条数计
+        // 环形缓冲区满时整批丢弃，同样按条数计
+        void PushBatch(const char* data, size_t len, const std::vector<BatchRecord>& records) {
+            uint32_t levels = 0;
+            LogLevel::value lowest = LogLevel::value::FATAL;
+            for (auto& r : records) {
+                levels |= LogLevel::Bit(r.level);
+                lowest = std::min(lowest, r.level);
+            }
+            if (ring_ && len <= ring_->MaxRecordSize()) {
+                PushRing(data, len, levels, records.size());
+                return;
+            }
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (AsyncType::ASYNC_SAFE == async_type_ || buffer_productor_.ReadableSize() + len <= Limit(lowest)) {
+                WaitForSpace(lock, len);
+                buffer_productor_.Push(data, len);
+                buffer_productor_.AddLevels(levels);
+                Publish();
+                return;
+            }
+            bool any = false;
+            for (auto& r : records) {
+                if (!Admit(r.len, r.level)) {
+                    Drop(r.len);
+                    continue;
+                }
+                buffer_productor_.Push(data + r.offset, r.len);
+                buffer_productor_.AddLevels(LogLevel::Bit(r.level));
+                any = true;
+            }
+            if (any)
+                Publish();
+        }
+
+        // Reserve方法：在生产者缓冲区中预留最多len字节并返回写入位置，调用者把数据直接写到这里，再用Commit提交实际长度
+        // 一直持有锁直到Commit，中间只能拷贝已经准备好的数据，不要做格式化等耗时的工作，也不能再调用本工作器的其他方法
+        // 过载策略在Commit时按实际写入的长度判断，预留的大小只是上限，不计入丢弃统计
+        // 环形缓冲区的槽位不连续，Reserve总是写入加锁的生产者缓冲区，同一线程不要与Push混用，以免顺序错乱
+        char* Reserve(size_t len, LogLevel::value level = LogLevel::value::FATAL) {
+            std::unique_lock<std::mutex> lock(mtx_); // 加锁保护生产者缓冲区
+            WaitForSpace(lock, len);
+            reserve_level_ = level;
+            char* p = buffer_productor_.Reserve(len);
+            lock.release(); // 保持加锁，由Commit解锁
+            return p;
+        }
+
+        // Commit方法：提交Reserve预留的空间中实际写入的len字节（不能超过预留的大小）并解锁
+        // ASYNC_UNSAFE下按实际长度和Reserve时的等级执行过载策略，被丢弃时返回false，丢弃字节数同样按实际长度计
+        bool Commit(size_t len) {
+            std::unique_lock<std::mutex> lock(mtx_, std::adopt_lock); // 接管Reserve持有的锁
+            if (AsyncType::ASYNC_UNSAFE == async_type_ && !Admit(len, reserve_level_)) {
+                Drop(len);
+                return false;
+            }
+            buffer_productor_.Commit(len);
+            buffer_productor_.AddLevels(LogLevel::Bit(reserve_level_));
+            Publish();
+            return true;
+        }
+
+        // 过载丢弃的日志条数和字节数（仅ASYNC_UNSAFE）
+        size_t DroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+        size_t DroppedBytes() const { return dropped_bytes_.load(std::memory_order_relaxed); }
+        // 消费者从挂起状态被唤醒（或超时醒来）的次数
+        size_t WakeupCount() const { return wakeups_.load(std::memory_order_relaxed); }
+        // 消费者醒来后却没有取到任何数据的次数
+        size_t EmptyDrainCount() const { return empty_drains_.load(std::memory_order_relaxed); }
+
+        // SetCollector方法：设置收取函数，消费者线程每轮交换缓冲区前在锁外调用，
+        // 收取函数通过PushCollected把暂存在别处的数据交给消费者；需要配合WaitPolicy::max_latency定时醒来
+        // 收取函数会获取暂存区自己的锁，而暂存区交出数据时是先持有暂存区的锁再Push，持有mtx_调用会反序加锁而死锁
+        void SetCollector(const std::function<void()>& collector) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            collector_ = collector;
+            has_collector_.store((bool)collector_, std::memory_order_release);
+        }
+
+        // SetIdleHandler方法：设置空闲函数，消费者线程某一轮没有取到任何数据时在锁外调用，
+        // 用于处理与新数据无关的定时工作（如按时间同步磁盘）；消费者挂起时最多休眠interval就醒来一次，
+        // 不改变生产者是否唤醒消费者，日志落地的延迟不受影响
+        void SetIdleHandler(const std::function<void()>& idle, std::chrono::milliseconds interval) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            idle_ = idle;
+            idle_interval_ = interval;
+        }
+
+        // SetIdleInterval方法：只修改空闲函数的定时间隔，可以在空闲函数和回调函数中调用
+        void SetIdleInterval(std::chrono::milliseconds interval) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            idle_interval_ = interval;
+        }
+
+        // PushCollected方法：只能在收取函数中调用（消费者线程，不持有mtx_），
+        // 与生产者的Push写入同一个队列，保证与该生产者之前、之后写入的日志顺序一致；从不等待也不丢弃
+        // levels是这段数据中日志等级的掩码
+        void PushCollected(const char* data, size_t len, uint32_t levels) {
+            if (ring_ && len <= ring_->MaxRecordSize()) {
+                // 环形缓冲区满时由消费者自己取出数据腾出空间
+                while (!ring_->TryPush(data, len, levels)) {
+                    if (ring_->PopTo(buffer_consumer_) == 0)
+                        std::this_thread::yield();
+                    else
+                        RingFreed(); // 生产者可能也在等待这次腾出的槽位
+                }
+                return;
             }
-            // 将数据推入生产者缓冲区
+            std::unique_lock<std::mutex> lock(mtx_);
             buffer_productor_.Push(data, len);
-            cond_consumer_.notify_one(); // notify_one()：唤醒一个等待的消费者线程，表示有新数据可处理
+            buffer_productor_.AddLevels(levels);
+            pending_.store(true, std::memory_order_release);
         }
 
-        // Stop方法：停止工作线程
+        // Stop方法：停止工作线程，可重复调用
         void Stop() {
-            stop_ = true; // 设置停止标志为true
+            if (!thread_.joinable()) return;
+            {
+                std::unique_lock<std::mutex> lock(mtx_); // 加锁设置，避免消费者检查完条件后才挂起而错过通知
+                stop_ = true; // 设置停止标志为true
+            }
             cond_consumer_.notify_all(); // 唤醒所有等待的消费者线程，使其检查stop_标志并退出
 			thread_.join(); // std::thread::join()会阻塞当前线程，直到工作线程执行完毕
         }
 
     private:
+        // Publish方法：持有mtx_时调用，生产者缓冲区写入新数据后标记并按需唤醒消费者
+        void Publish() {
+            if (!pending_.load(std::memory_order_relaxed))
+                pending_.store(true, std::memory_order_release); // 标记有数据，供消费者自旋时无锁检查
+            // 只有消费者已经挂起时才需要唤醒，避免每条日志都调用notify
+            if (consumer_parked_ && wait_policy_.max_latency.count() == 0)
+                cond_consumer_.notify_one(); // notify_one()：唤醒一个等待的消费者线程，表示有新数据可处理
+        }
+
+        // WaitForSpace方法：持有mtx_时调用，ASYNC_SAFE模式下生产者缓冲区空间不足时等待
+        // 超过容量的单条日志在缓冲区为空时写入，不会永远等待
+        void WaitForSpace(std::unique_lock<std::mutex>& lock, size_t len) {
+            if (AsyncType::ASYNC_SAFE == async_type_ && len > buffer_productor_.WriteableSize() && !buffer_productor_.IsEmpty()) {
+                if (consumer_parked_) cond_consumer_.notify_one(); // 确保消费者醒着，否则可能永远等不到空间
+                cond_productor_.wait(lock, [&](){ return len <= buffer_productor_.WriteableSize() || buffer_productor_.IsEmpty();});
+				//std::condition_variable::wait会自动释放锁，等待条件满足后再重新加锁，参数：(锁， 条件)
+            }
+        }
+
+        // PushRing方法：无锁写入环形缓冲区，levels是这段数据中日志等级的掩码，records是日志条数，丢弃时计数
+        void PushRing(const char* data, size_t len, uint32_t levels, size_t records = 1) {
+            int spins = 0;
+            while (!ring_->TryPush(data, len, levels)) {
+                if (AsyncType::ASYNC_UNSAFE == async_type_) {
+                    Drop(len, records); // 不安全模式：满了直接丢弃
+                    return;
+                }
+                // 安全模式：先短暂自旋让出CPU，仍然没有空间再挂起，直到消费者释放槽位后通知
+                if (++spins < 64) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mtx_);
+                // 持锁记下释放次数后再试一次：之后的释放一定会增加ring_frees_并通知，不会错过唤醒
+                size_t frees = ring_frees_;
+                if (ring_->TryPush(data, len, levels))
+                    break;
+                if (consumer_parked_) cond_consumer_.notify_one(); // 确保消费者醒着，否则可能永远等不到空间
+                ++productor_waiting_;
+                cond_productor_.wait(lock, [&](){ return ring_frees_ != frees; });
+                --productor_waiting_;
+            }
+            if (wait_policy_.max_latency.count() == 0) {
+                // 与WaitForData中的栅栏配对：要么消费者看到新数据，要么生产者看到消费者已挂起
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (consumer_parked_.load(std::memory_order_relaxed)) {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    cond_consumer_.notify_one();
+                }
+            }
+        }
+
+        // RingFreed方法：消费者从环形缓冲区取出数据、释放槽位后调用，唤醒等待空间的生产者
+        void RingFreed() {
+            std::unique_lock<std::mutex> lock(mtx_);
+            RingFreedLocked();
+        }
+
+        // RingFreedLocked方法：持有mtx_时调用的RingFreed
+        void RingFreedLocked() {
+            ++ring_frees_;
+            if (productor_waiting_ > 0)
+                cond_productor_.notify_all();
+        }
+
+        // Admit方法：持有mtx_时调用，按过载策略判断这条日志能否写入生产者缓冲区
+        bool Admit(size_t len, LogLevel::value level) {
+            size_t fill = buffer_productor_.ReadableSize() + len;
+            if (fill <= Limit(level))
+                return true;
+            // SAMPLE：超过一半容量后按间隔采样，达到上限后全部丢弃
+            return overload_.drop == DropPolicy::SAMPLE && fill <= overload_.max_bytes &&
+                sample_seq_++ % overload_.sample_rate == 0;
+        }
+
+        // Limit方法：该等级的日志不经采样、一定能写入时待消费数据的上限
+        size_t Limit(LogLevel::value level) const {
+            size_t cap = overload_.max_bytes;
+            switch (overload_.drop) {
+            case DropPolicy::DROP_LOWEST_LEVEL: {
+                static const size_t percent[] = {50, 75, 90, 100, 100}; // 各等级允许占用的容量百分比
+                return cap / 100 * percent[(int)level];
+            }
+            case DropPolicy::SAMPLE:
+                return cap / 2;
+            default:
+                return cap;
+            }
+        }
+
+        // 记录被丢弃的日志，records为这段数据包含的日志条数
+        void Drop(size_t len, size_t records = 1) {
+            dropped_.fetch_add(records, std::memory_order_relaxed);
+            dropped_bytes_.fetch_add(len, std::memory_order_relaxed);
+        }
+
+        // 是否有待消费的数据，不加锁，供消费者自旋时检查
+        bool HasData() {
+            return pending_.load(std::memory_order_acquire) || (ring_ && !ring_->IsEmpty());
+        }
+
+        // WaitForData方法：消费者空闲时的等待，先自旋再挂起
+        void WaitForData() {
+            for (size_t i = 0; i < wait_policy_.spin_count; ++i) {
+                if (HasData() || stop_) return;
+                CpuRelax();
+            }
+            std::unique_lock<std::mutex> lock(mtx_);
+            consumer_parked_.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto ready = [&]() { return stop_ || HasData(); };
+            std::chrono::milliseconds timeout = wait_policy_.max_latency;
+            if (idle_ && idle_interval_.count() > 0 && (timeout.count() == 0 || idle_interval_ < timeout))
+                timeout = idle_interval_; // 空闲函数需要定时执行
+            if (timeout.count() > 0)
+                cond_consumer_.wait_for(lock, timeout, ready);
+            else
+                cond_consumer_.wait(lock, ready);
+            consumer_parked_.store(false, std::memory_order_relaxed);
+            wakeups_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 自旋等待时降低CPU占用，减少对超线程兄弟核的干扰
+        static void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+
         // ThreadEntry方法：异步工作线程的入口函数：thread_(std::thread(&AsyncWorker::ThreadEntry, this))
         void ThreadEntry() {
             while (1) {
+                // 没有数据时按等待策略自旋或挂起，避免空转并反复调用落地回调
+                if (!HasData() && !stop_)
+                    WaitForData();
+
+                // 先在锁外收取暂存在别处（如线程暂存区）的数据，收取函数通过PushCollected写入
+                // collector_只在SetCollector中持锁修改，has_collector_的acquire保证看到修改后的值
+                bool collecting = has_collector_.load(std::memory_order_acquire); // 本轮是否设置了收取函数
+                if (collecting)
+                    collector_();
+                bool has_idle = false; // 是否设置了空闲函数
                 { // 缓冲区交换的临界区
                     std::unique_lock<std::mutex> lock(mtx_); // 加锁保护缓冲区交换操作
-                    // 如果生产者缓冲区为空且stop_标志为true，等待新数据或停止信号
-                    // 否则（有数据或stop_为false），则继续执行
-                    if (buffer_productor_.IsEmpty() && stop_) {
-                        cond_consumer_.wait(lock, [&]() { return stop_ || !buffer_productor_.IsEmpty();});
-                    }  // 有数据则交换，无数据就阻塞
-                        
-                    // 交换生产者和消费者缓冲区，快速释放锁让生产者继续写入
-                    buffer_productor_.Swap(buffer_consumer_);
+                    has_idle = (bool)idle_;
+
+                    // 环形缓冲区模式：批量取出所有已发布的日志，追加到消费者缓冲区
+                    if (ring_ && ring_->PopTo(buffer_consumer_) > 0)
+                        RingFreedLocked(); // 腾出了槽位，唤醒等待空间的生产者
+
+                    // 把生产者缓冲区的分段整体移到消费者缓冲区，不拷贝数据，快速释放锁让生产者继续写入
+                    // 消费者缓冲区已有环形缓冲区的数据时，生产者缓冲区的分段接在后面
+                    if (!buffer_productor_.IsEmpty()) {
+                        buffer_consumer_.Append(buffer_productor_);
+                        pending_.store(false, std::memory_order_relaxed);
+                    }
 
                     // 如果是ASYNC_SAFE模式，通知生产者线程可以继续写入（缓冲区有空间了）
                     if (async_type_ == AsyncType::ASYNC_SAFE)
                         cond_productor_.notify_one();
                 } // 锁在这里被释放
 
-                // 调用回调函数处理消费者缓冲区中的数据（实际的日志落地）
-                callback_(buffer_consumer_); 
-                buffer_consumer_.Reset(); // 重置消费者缓冲区，准备下一次接收数据
+                // 只有取到数据才调用回调函数处理消费者缓冲区中的数据（实际的日志落地）
+                // 设置了collector_时每轮都回调，回调可能还持有上一轮留下的数据，需要由它自行判断
+                if (buffer_consumer_.IsEmpty())
+                    empty_drains_.fetch_add(1, std::memory_order_relaxed);
+                if (!buffer_consumer_.IsEmpty() || collecting) {
+                    callback_(buffer_consumer_);
+                    buffer_consumer_.Reset(); // 重置消费者缓冲区，准备下一次接收数据
+                } else if (has_idle) {
+                    idle_(); // 只在SetIdleHandler中持锁修改，这里已在锁内确认过，可以在锁外调用
+                }
 
                 // 如果停止标志为true且生产者缓冲区也为空，则工作完成，线程退出
-                if (stop_ && buffer_productor_.IsEmpty()) return;
+                if (stop_ && !HasData()) return;
             }
         }
 
     private:
         AsyncType async_type_; // 异步模式类型 (安全/不安全)
-        std::atomic<bool> stop_;  // 控制异步工作器是否停止的原子标志 
+        BufferType buffer_type_; // 缓冲区实现方式 (双缓冲区/环形缓冲区)
+        WaitPolicy wait_policy_; // 消费者空闲时的等待策略
+        OverloadPolicy overload_; // 过载策略
+        size_t sample_seq_ = 0; // SAMPLE策略的计数，受mtx_保护
+        LogLevel::value reserve_level_ = LogLevel::value::FATAL; // Reserve传入的等级，Commit时执行过载策略，受mtx_保护
+        std::atomic<bool> stop_;  // 控制异步工作器是否停止的原子标志
         // 在软件开发中，原子（atomic） 通常指“原子操作”，即一个操作要么全部完成，要么完全不做，中间不会被其他线程打断。
         // 原子操作是多线程编程中保证数据一致性和线程安全的基础。
         std::mutex mtx_; // 保护共享资源的互斥锁
@@ -93,8 +425,22 @@ namespace mylog {
         mylog::Buffer buffer_consumer_; // 消费者缓冲区，用于日志落地
         std::condition_variable cond_productor_; // 生产者条件变量，用于生产者等待缓冲区空间
         std::condition_variable cond_consumer_; // 消费者条件变量，用于消费者等待数据
-        std::thread thread_; // 异步工作线程
+        std::unique_ptr<RingBuffer> ring_ = buffer_type_ == BufferType::RING_BUFFER
+            ? std::unique_ptr<RingBuffer>(new RingBuffer(g_conf_data->ring_capacity)) : nullptr; // 环形缓冲区，仅RING_BUFFER模式创建
+        size_t productor_waiting_ = 0; // 因环形缓冲区满而等待的生产者数量，受mtx_保护
+        size_t ring_frees_ = 0; // 消费者释放环形缓冲区槽位的次数，生产者据此判断是否有了新空间，受mtx_保护
+        std::atomic<size_t> dropped_{0}; // 过载丢弃的日志条数
+        std::atomic<size_t> dropped_bytes_{0}; // 过载丢弃的字节数
+        std::atomic<bool> pending_{false}; // 双缓冲区中是否有未交换的数据
+        std::atomic<bool> consumer_parked_{false}; // 消费者是否已挂起在cond_consumer_上
+        std::atomic<size_t> wakeups_{0}; // 消费者被唤醒的次数
+        std::atomic<size_t> empty_drains_{0}; // 消费者空取的次数
 
         functor callback_;  // 回调函数，用于告知工作器如何将日志落地
+        std::function<void()> collector_; // 收取函数，把暂存在别处的数据交给消费者
+        std::atomic<bool> has_collector_{false}; // 是否设置了收取函数，消费者在锁外读取
+        std::function<void()> idle_; // 空闲函数，消费者没有取到数据时调用
+        std::chrono::milliseconds idle_interval_{0}; // 消费者挂起时执行空闲函数的间隔
+        std::thread thread_; // 异步工作线程，必须最后声明
     };
-}  // namespace mylog
\ No newline at end of file
+}  // namespace mylog
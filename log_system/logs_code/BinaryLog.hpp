@@ -0,0 +1,467 @@
+/*延迟格式化的二进制日志设计*/
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "Level.hpp" // 日志级别定义
+#include "Format.hpp" // 参数的文本格式化
+#include "Message.hpp" // 日志行的统一格式
+#include "Util.hpp" // 时间工具
+
+namespace mylog {
+    // 日志调用点：文件、行号、等级和格式串在程序运行期间不变，只登记一次，记录中只写调用点id
+    struct CallSite {
+        static constexpr uint32_t kUnregistered = UINT32_MAX; // 调用点表已满时没有登记的调用点id
+
+        uint32_t id;            // 调用点id
+        uint32_t line;          // 行号
+        LogLevel::value level;  // 第一次登记时的等级，只用于离线解码的SITE记录，每条记录的等级在记录头中
+        const char* file;       // 文件名（字符串字面量）
+        const char* format;     // {}风格的格式串（字符串字面量）
+    };
+
+    // CallSiteRegistry：全局调用点表，登记时加锁，按id查找时无锁
+    class CallSiteRegistry {
+    public:
+        // Register：登记一个调用点，一般由MYLOG_*宏中的静态局部变量调用一次
+        // 已发布的槽位不再修改：调用点表满时返回一个不在表中的调用点（id为kUnregistered），
+        // 日志器对它在调用线程立即格式化，不写入调用点id
+        static const CallSite& Register(const char* file, size_t line, LogLevel::value level, const char* format)
+        {
+            Storage& s = Instance();
+            std::unique_lock<std::mutex> lock(s.mtx);
+            uint32_t id = s.next;
+            if (id >= kChunkSize * kMaxChunks) // 每个调用点只登记一次，这里分配的内存不会随日志条数增长
+                return *new CallSite{CallSite::kUnregistered, (uint32_t)line, level, file, format};
+            ++s.next;
+            CallSite* chunk = s.chunks[id / kChunkSize].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                chunk = new CallSite[kChunkSize];
+                s.chunks[id / kChunkSize].store(chunk, std::memory_order_release);
+            }
+            chunk[id % kChunkSize] = CallSite{id, (uint32_t)line, level, file, format};
+            return chunk[id % kChunkSize];
+        }
+
+        // Get：按id查找调用点，记录经过AsyncWorker传递，登记时的写入对消费者线程一定可见
+        static const CallSite* Get(uint32_t id)
+        {
+            if (id >= kChunkSize * kMaxChunks)
+                return nullptr;
+            CallSite* chunk = Instance().chunks[id / kChunkSize].load(std::memory_order_acquire);
+            return chunk ? &chunk[id % kChunkSize] : nullptr;
+        }
+
+    private:
+        static constexpr size_t kChunkSize = 1024; // 每块调用点数量
+        static constexpr size_t kMaxChunks = 1024; // 最多块数
+        struct Storage {
+            std::mutex mtx;
+            uint32_t next = 0;
+            std::atomic<CallSite*> chunks[kMaxChunks] = {};
+        };
+        static Storage& Instance()
+        {
+            static Storage s;
+            return s;
+        }
+    };
+
+    // 记录类型：延迟格式化的日志器在缓冲区中写入带记录头的记录
+    enum class RecordKind : uint8_t {
+        TEXT = 1,   // 已格式化的文本日志
+        BINARY = 2, // 调用点id加原始参数，由消费者线程格式化
+        SITE = 3,   // 调用点登记信息，只出现在原始二进制输出中，供离线解码
+        MESSAGE = 4,// 文本接口的日志：行号、文件名、日志器名和信息体，由消费者线程按各刷新器的格式输出
+    };
+
+    // 记录头，所有字段按本机字节序写入
+    struct RecordHeader {
+        uint32_t size;     // 整条记录长度（含记录头）
+        uint8_t kind;      // RecordKind
+        uint8_t level;     // LogLevel::value
+        uint16_t reserved; // 保留
+        uint32_t site;     // 调用点id
+        uint32_t reserved2;// 保留
+        uint64_t ts_ns;    // 产生时间，墙上时钟纳秒
+        uint64_t tid;      // 产生日志的线程ID
+    };
+    static_assert(sizeof(RecordHeader) == 32, "RecordHeader layout changed");
+
+    // 参数类型标记，解码时据此还原参数
+    // FIELD是结构化字段的键：长度(uint32) + 键，紧跟着的一个参数是它的值
+    enum class ArgTag : uint8_t { INT64, UINT64, DOUBLE, BOOL, CHAR, STRING, POINTER, FIELD };
+
+    // 当前线程ID的数值形式，与文本日志中的线程ID一致
+    inline uint64_t ThreadIdNumber()
+    {
+        thread_local uint64_t tid = strtoull(LogMessage::ThreadIdString().c_str(), nullptr, 10);
+        return tid;
+    }
+
+    // EncodeArg：把一个参数按类型标记加原始字节追加到out，支持的类型与fmt::AppendArg一致
+    // 结构化字段写为FIELD标记和键，再写值
+    template <typename T>
+    void EncodeArg(std::string& out, const T& v)
+    {
+        using D = std::decay_t<T>;
+        auto put = [&out](ArgTag tag, const void* p, size_t n) {
+            out.push_back((char)tag);
+            out.append((const char*)p, n);
+        };
+        if constexpr (fmt::IsKeyValue<D>::value) {
+            uint32_t n = (uint32_t)strlen(v.key);
+            put(ArgTag::FIELD, &n, sizeof(n));
+            out.append(v.key, n);
+            EncodeArg(out, v.value);
+        } else if constexpr (std::is_same_v<D, bool>) {
+            put(ArgTag::BOOL, &v, 1);
+        } else if constexpr (std::is_same_v<D, char>) {
+            put(ArgTag::CHAR, &v, 1);
+        } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+            int64_t x = v;
+            put(ArgTag::INT64, &x, sizeof(x));
+        } else if constexpr (std::is_integral_v<D>) {
+            uint64_t x = v;
+            put(ArgTag::UINT64, &x, sizeof(x));
+        } else if constexpr (std::is_floating_point_v<D>) {
+            double x = v;
+            put(ArgTag::DOUBLE, &x, sizeof(x));
+        } else if constexpr (std::is_enum_v<D>) {
+            EncodeArg(out, static_cast<std::underlying_type_t<D>>(v));
+        } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*> ||
+                             std::is_convertible_v<const T&, std::string_view>) {
+            std::string_view sv;
+            if constexpr (std::is_array_v<T>)
+                sv = v;
+            else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>)
+                sv = v ? std::string_view(v) : std::string_view("(null)");
+            else
+                sv = v;
+            uint32_t n = (uint32_t)sv.size();
+            put(ArgTag::STRING, &n, sizeof(n));
+            out.append(sv.data(), n);
+        } else if constexpr (std::is_pointer_v<D>) {
+            uint64_t x = reinterpret_cast<uintptr_t>(v);
+            put(ArgTag::POINTER, &x, sizeof(x));
+        } else {
+            static_assert(fmt::AlwaysFalse<T>::value, "mylog: unsupported log argument type");
+        }
+    }
+
+    // DecodeArg：从p解码一个参数并以文本形式追加到out，数据不完整时返回false
+    // json为true时按JSON的值输出：字符、字符串和指针加引号并转义，非有限的浮点数输出为null
+    inline bool DecodeArg(std::string& out, const char*& p, const char* end, bool json = false)
+    {
+        if (p >= end)
+            return false;
+        ArgTag tag = (ArgTag)*p++;
+        auto take = [&](void* dst, size_t n) {
+            if ((size_t)(end - p) < n) return false;
+            memcpy(dst, p, n);
+            p += n;
+            return true;
+        };
+        switch (tag) {
+            case ArgTag::BOOL: { bool v; if (!take(&v, 1)) return false; fmt::AppendArg(out, v); return true; }
+            case ArgTag::CHAR: {
+                char v;
+                if (!take(&v, 1)) return false;
+                if (json) fmt::AppendJson(out, std::string_view(&v, 1)); else fmt::AppendArg(out, v);
+                return true;
+            }
+            case ArgTag::INT64: { int64_t v; if (!take(&v, 8)) return false; fmt::AppendArg(out, v); return true; }
+            case ArgTag::UINT64: { uint64_t v; if (!take(&v, 8)) return false; fmt::AppendArg(out, v); return true; }
+            case ArgTag::DOUBLE: {
+                double v;
+                if (!take(&v, 8)) return false;
+                if (json && !std::isfinite(v)) out.append("null"); else fmt::AppendArg(out, v);
+                return true;
+            }
+            case ArgTag::POINTER: {
+                uint64_t v;
+                if (!take(&v, 8)) return false;
+                if (json) out.push_back('"');
+                fmt::AppendArg(out, (const void*)(uintptr_t)v);
+                if (json) out.push_back('"');
+                return true;
+            }
+            case ArgTag::STRING: {
+                uint32_t n;
+                if (!take(&n, sizeof(n)) || (size_t)(end - p) < n) return false;
+                if (json) fmt::AppendJson(out, std::string_view(p, n)); else out.append(p, n);
+                p += n;
+                return true;
+            }
+            case ArgTag::FIELD:
+                return false; // 字段由DecodeField解码
+        }
+        return false;
+    }
+
+    // DecodeField：从p解码一个结构化字段（FIELD标记、键和值）追加到out，数据不完整时返回false
+    // 文本形式为" 键=值"，json为true时为已转义的对象成员",\"键\":值"
+    inline bool DecodeField(std::string& out, const char*& p, const char* end, bool json)
+    {
+        uint32_t n;
+        if (p >= end || (ArgTag)*p != ArgTag::FIELD || (size_t)(end - p) < 1 + sizeof(n))
+            return false;
+        memcpy(&n, p + 1, sizeof(n));
+        p += 1 + sizeof(n);
+        if ((size_t)(end - p) < n)
+            return false;
+        std::string_view key(p, n);
+        p += n;
+        if (json) {
+            out.push_back(',');
+            fmt::AppendJson(out, key);
+            out.push_back(':');
+        } else {
+            out.push_back(' ');
+            out.append(key.data(), key.size()).push_back('=');
+        }
+        return DecodeArg(out, p, end, json);
+    }
+
+    // 在out的begin处补写记录头，记录内容必须已经追加在记录头之后
+    inline void FinishRecord(std::string& out, size_t begin, RecordKind kind, LogLevel::value level, uint32_t site)
+    {
+        RecordHeader head{};
+        head.size = (uint32_t)(out.size() - begin);
+        head.kind = (uint8_t)kind;
+        head.level = (uint8_t)level;
+        head.site = site;
+        head.ts_ns = Clock::NowNs();
+        head.tid = ThreadIdNumber();
+        memcpy(&out[begin], &head, sizeof(head));
+    }
+
+    // EncodeRecord：生产者线程调用，只拷贝参数的原始字节，不做任何文本格式化
+    // 等级写入记录头，还原时以记录头为准，不使用调用点登记时的等级
+    template <typename... Args>
+    void EncodeRecord(std::string& out, const CallSite& site, LogLevel::value level, const Args&... args)
+    {
+        size_t begin = out.size();
+        out.append(sizeof(RecordHeader), '\0');
+        (EncodeArg(out, args), ...);
+        FinishRecord(out, begin, RecordKind::BINARY, level, site.id);
+    }
+
+    // EncodeMessage：文本接口的日志在延迟格式化的日志器中只保存字段，不拼接日志行
+    // 记录内容：行号(uint32) + 文件名\0 + 日志器名\0 + 信息体
+    inline void EncodeMessage(std::string& out, LogLevel::value level, const char* file, size_t line,
+        const std::string& logger, const char* payload, size_t len)
+    {
+        size_t begin = out.size();
+        out.append(sizeof(RecordHeader), '\0');
+        uint32_t l = (uint32_t)line;
+        out.append((const char*)&l, sizeof(l));
+        out.append(file).push_back('\0');
+        out.append(logger).push_back('\0');
+        out.append(payload, len);
+        FinishRecord(out, begin, RecordKind::MESSAGE, level, 0);
+    }
+
+    // RecordRenderer：把带记录头的记录还原为文本日志
+    // 消费者线程和离线解码工具共用：调用点信息优先取自数据中的SITE记录，找不到时查全局调用点表
+    class RecordRenderer {
+    public:
+        explicit RecordRenderer(const std::string& logger_name = "") : logger_name_(logger_name) {}
+
+        // Render：把data中等级在levels中的记录按pattern转换为文本追加到text
+        // 返回已处理的字节数，末尾不完整的记录不处理
+        size_t Render(const char* data, size_t len, std::string& text,
+            const Pattern& pattern = *Pattern::Default(), uint32_t levels = LogLevel::kAllLevels)
+        {
+            return ForEach(data, len, levels, [&](const RecordHeader& head, const char* body, const char* end) {
+                switch ((RecordKind)head.kind) {
+                    case RecordKind::TEXT:
+                        text.append(body, end - body);
+                        break;
+                    case RecordKind::BINARY:
+                        RenderBinary(head, body, end, text, pattern);
+                        break;
+                    case RecordKind::MESSAGE:
+                        RenderMessage(head, body, end, text, pattern);
+                        break;
+                    default:
+                        break;
+                }
+            });
+        }
+
+        // Raw：把data中等级在levels中的记录原样追加到raw，并在每个调用点第一次出现前插入它的SITE记录，
+        // 使原始输出可以脱离本进程解码；返回已处理的字节数
+        size_t Raw(const char* data, size_t len, std::string& raw, uint32_t levels = LogLevel::kAllLevels)
+        {
+            return ForEach(data, len, levels, [&](const RecordHeader& head, const char* body, const char* /*end*/) {
+                if ((RecordKind)head.kind == RecordKind::BINARY && emitted_.count(head.site) == 0) {
+                    const SiteInfo* site = Lookup(head.site);
+                    if (site != nullptr) {
+                        emitted_.insert(head.site);
+                        AppendSite(raw, head.site, *site);
+                    }
+                }
+                raw.append(body - sizeof(head), head.size);
+            });
+        }
+
+    private:
+        // ForEach：逐条遍历完整的记录，SITE记录在这里登记，其余等级在levels中的记录交给f
+        template <typename F>
+        size_t ForEach(const char* data, size_t len, uint32_t levels, F&& f)
+        {
+            size_t pos = 0;
+            while (pos + sizeof(RecordHeader) <= len)
+            {
+                RecordHeader head;
+                memcpy(&head, data + pos, sizeof(head));
+                if (head.size < sizeof(head) || pos + head.size > len)
+                    break;
+                const char* body = data + pos + sizeof(head);
+                const char* end = data + pos + head.size;
+                if ((RecordKind)head.kind == RecordKind::SITE)
+                    LoadSite(head, body, end);
+                else if (head.level < 32 && (levels & (1u << head.level)))
+                    f(head, body, end);
+                pos += head.size;
+            }
+            return pos;
+        }
+
+        struct SiteInfo {
+            uint32_t line;
+            LogLevel::value level;
+            std::string file;
+            std::string format;
+            std::string logger;
+        };
+
+        void RenderBinary(const RecordHeader& head, const char* body, const char* end, std::string& text, const Pattern& pattern)
+        {
+            const SiteInfo* site = Lookup(head.site);
+            if (site == nullptr) {
+                text.append("[unknown call site ").append(std::to_string(head.site)).append("]\n");
+                return;
+            }
+
+            // 按格式串依次把参数还原为文本，结构化字段按输出格式单独还原
+            bool json = pattern.IsJson();
+            payload_.clear();
+            fields_.clear();
+            const char* f = site->format.c_str();
+            while (body < end) {
+                bool ok;
+                if ((ArgTag)*body == ArgTag::FIELD)
+                    ok = DecodeField(fields_, body, end, json);
+                else if (f && (f = fmt::AppendLiteral(payload_, f)))
+                    ok = DecodeArg(payload_, body, end);
+                else
+                    ok = DecodeArg(extra_, body, end); // 多于占位符的参数不输出
+                if (!ok)
+                    break;
+            }
+            extra_.clear();
+            while (f && (f = fmt::AppendLiteral(payload_, f)))
+                payload_.append("{}");
+            if (!json) { // 文本输出时字段追加在信息体之后，与调用线程格式化的结果一致
+                payload_.append(fields_);
+                fields_.clear();
+            }
+
+            pattern.FormatTo(text, LogFields{head.ts_ns, (LogLevel::value)head.level, site->file, site->line,
+                site->logger, Tid(head.tid), payload_, fields_});
+        }
+
+        void RenderMessage(const RecordHeader& head, const char* body, const char* end, std::string& text, const Pattern& pattern)
+        {
+            uint32_t line;
+            if ((size_t)(end - body) < sizeof(line))
+                return;
+            memcpy(&line, body, sizeof(line));
+            body += sizeof(line);
+            std::string_view fields[2]; // 文件名、日志器名
+            for (auto& f : fields) {
+                const char* zero = (const char*)memchr(body, '\0', end - body);
+                if (zero == nullptr)
+                    return;
+                f = std::string_view(body, zero - body);
+                body = zero + 1;
+            }
+            pattern.FormatTo(text, LogFields{head.ts_ns, (LogLevel::value)head.level, fields[0], line,
+                fields[1], Tid(head.tid), std::string_view(body, end - body)});
+        }
+
+        // 线程ID文本，同一线程连续的记录只转换一次
+        const std::string& Tid(uint64_t tid)
+        {
+            if (tid != last_tid_ || tid_.empty()) {
+                tid_.clear();
+                fmt::AppendArg(tid_, tid);
+                last_tid_ = tid;
+            }
+            return tid_;
+        }
+
+        // 查找调用点，第一次查到全局调用点表时缓存一份字符串，之后不再访问全局表
+        const SiteInfo* Lookup(uint32_t id)
+        {
+            auto it = sites_.find(id);
+            if (it != sites_.end())
+                return &it->second;
+            const CallSite* cs = CallSiteRegistry::Get(id);
+            if (cs == nullptr || cs->file == nullptr)
+                return nullptr;
+            SiteInfo& info = sites_[id];
+            info = SiteInfo{cs->line, cs->level, cs->file, cs->format, logger_name_};
+            return &info;
+        }
+
+        // SITE记录内容：行号(uint32) + 文件名\0 + 格式串\0 + 日志器名\0
+        void AppendSite(std::string& out, uint32_t id, const SiteInfo& site)
+        {
+            size_t begin = out.size();
+            out.append(sizeof(RecordHeader), '\0');
+            out.append((const char*)&site.line, sizeof(site.line));
+            out.append(site.file).push_back('\0');
+            out.append(site.format).push_back('\0');
+            out.append(site.logger).push_back('\0');
+            FinishRecord(out, begin, RecordKind::SITE, site.level, id);
+        }
+
+        void LoadSite(const RecordHeader& head, const char* body, const char* end)
+        {
+            SiteInfo info;
+            if ((size_t)(end - body) < sizeof(info.line))
+                return;
+            memcpy(&info.line, body, sizeof(info.line));
+            body += sizeof(info.line);
+            std::string* fields[] = {&info.file, &info.format, &info.logger};
+            for (std::string* f : fields) {
+                const char* zero = (const char*)memchr(body, '\0', end - body);
+                if (zero == nullptr)
+                    return;
+                f->assign(body, zero - body);
+                body = zero + 1;
+            }
+            info.level = (LogLevel::value)head.level;
+            sites_[head.site] = std::move(info);
+        }
+
+    private:
+        std::string logger_name_;                       // 日志器名
+        std::unordered_map<uint32_t, SiteInfo> sites_;  // 已知的调用点
+        std::unordered_set<uint32_t> emitted_;          // 已写入原始输出的调用点
+        std::string payload_;                           // 还原信息体的临时缓冲区
+        std::string fields_;                            // 还原结构化字段的临时缓冲区
+        std::string extra_;                             // 多余参数的临时缓冲区
+        std::string tid_;                               // 线程ID文本
+        uint64_t last_tid_ = 0;                         // tid_对应的线程ID
+    };
+} // namespace mylog
@@ -0,0 +1,70 @@
+/*日志时间戳的时钟服务设计*/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace mylog {
+    // Clock：日志记录使用的时钟
+    // 时间戳统一为墙上时钟纳秒数，时:分:秒部分在每个线程中按秒缓存，同一秒内的日志不再调用localtime_r和strftime
+    // 小数部分的位数由time_precision决定：0只输出到秒，3毫秒，6微秒，9纳秒
+    class Clock {
+    public:
+        static constexpr size_t kMaxTimeSize = 18; // 时:分:秒.纳秒的最大长度
+
+        // 当前时间的纳秒数
+        // 只输出到秒时使用CLOCK_REALTIME_COARSE，读取的是内核上次时钟中断时的时间，开销最小
+        // 需要亚秒精度时使用CLOCK_REALTIME，在vDSO中完成，不陷入内核
+        static uint64_t NowNs()
+        {
+            struct timespec ts;
+            clock_gettime(Precision() == 0 ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME, &ts);
+            return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+        }
+
+        // 小数部分的位数，超过9时按9处理
+        static size_t Precision() { return PrecisionSlot().load(std::memory_order_relaxed); }
+        static void SetPrecision(size_t digits)
+        {
+            PrecisionSlot().store(digits > 9 ? 9 : digits, std::memory_order_relaxed);
+        }
+
+        // FormatTime：把纳秒时间戳格式化为时:分:秒[.小数]写入out，out至少要有kMaxTimeSize字节，返回写入的字节数
+        static size_t FormatTime(char* out, uint64_t ns)
+        {
+            time_t sec = (time_t)(ns / 1000000000ull);
+            struct SecondCache {
+                time_t sec = -1;
+                char text[9];
+            };
+            thread_local SecondCache cache;
+            if (cache.sec != sec) { // 进入新的一秒才重新转换本地时间
+                struct tm t;
+                localtime_r(&sec, &t);
+                strftime(cache.text, sizeof(cache.text), "%H:%M:%S", &t);
+                cache.sec = sec;
+            }
+            memcpy(out, cache.text, 8);
+            size_t digits = Precision();
+            if (digits == 0)
+                return 8;
+            out[8] = '.';
+            uint64_t frac = ns % 1000000000ull;
+            for (size_t i = digits; i < 9; ++i) // 截掉多余的低位
+                frac /= 10;
+            for (size_t i = digits; i > 0; --i) { // 从低位往高位写，不足位数补0
+                out[8 + i] = '0' + frac % 10;
+                frac /= 10;
+            }
+            return 9 + digits;
+        }
+
+    private:
+        static std::atomic<size_t>& PrecisionSlot()
+        {
+            static std::atomic<size_t> digits{6}; // 默认微秒，日志器创建时按配置中的time_precision设置
+            return digits;
+        }
+    };
+} // namespace mylog
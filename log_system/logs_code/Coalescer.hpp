@@ -0,0 +1,124 @@
+/*重复日志折叠设计*/
+#pragma once
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "BinaryLog.hpp" // 带记录头的记录
+
+namespace mylog {
+    // RecordCoalescer：消费者线程中折叠同一调用点连续重复的日志
+    // 同一调用点在window内再次输出完全相同的日志时只计数不输出，窗口结束或该调用点输出了不同的内容时，
+    // 补一条"last message repeated N times"，故障期间同一行日志每个窗口最多输出一次
+    // 只处理带记录头的记录（延迟格式化），调用点对BINARY记录是调用点id，对MESSAGE记录是文件名加行号
+    class RecordCoalescer {
+    public:
+        RecordCoalescer(std::chrono::milliseconds window, const std::string& logger_name)
+            : window_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(window).count()),
+            logger_name_(logger_name) {}
+
+        // Filter：把data中需要输出的记录追加到out，重复的记录只计数
+        void Filter(const char* data, size_t len, std::string& out)
+        {
+            size_t pos = 0;
+            while (pos + sizeof(RecordHeader) <= len)
+            {
+                RecordHeader head;
+                memcpy(&head, data + pos, sizeof(head));
+                if (head.size < sizeof(head) || pos + head.size > len)
+                    break;
+                const char* record = data + pos;
+                pos += head.size;
+                std::string_view body(record + sizeof(head), head.size - sizeof(head));
+                RecordKind kind = (RecordKind)head.kind;
+                if (kind != RecordKind::BINARY && kind != RecordKind::MESSAGE) {
+                    out.append(record, head.size);
+                    continue;
+                }
+                Site& site = sites_[SiteKey(head, body)];
+                if (site.seen && site.kind == head.kind && site.last.level == head.level && site.body == body && head.ts_ns < site.first_ns + window_ns_) {
+                    ++site.repeats; // 窗口内的重复日志，只记住最后一次的时间和线程
+                    site.last = head;
+                    continue;
+                }
+                Summarize(site, out);
+                site.seen = true;
+                site.kind = head.kind;
+                site.body.assign(body.data(), body.size());
+                site.first_ns = head.ts_ns;
+                site.last = head;
+                out.append(record, head.size);
+            }
+        }
+
+        // Expire：窗口已结束的调用点补上重复次数，all为true时不论窗口全部补上（日志器析构时）
+        void Expire(std::string& out, bool all = false)
+        {
+            uint64_t now = Clock::NowNs();
+            for (auto it = sites_.begin(); it != sites_.end();) {
+                Site& site = it->second;
+                bool expired = now >= site.first_ns + window_ns_;
+                if (site.repeats > 0 && (all || expired))
+                    Summarize(site, out);
+                if (expired && site.repeats == 0) // 长时间不再出现的调用点不再保留，内存不随调用点增长
+                    it = sites_.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+    private:
+        struct Site {
+            bool seen = false;       // 是否有上一条日志
+            uint8_t kind = 0;        // 上一条日志的记录类型
+            std::string body;        // 上一条日志的内容，用于判断是否完全相同
+            uint64_t first_ns = 0;   // 本窗口第一条日志的时间
+            size_t repeats = 0;      // 本窗口中被折叠的条数
+            RecordHeader last{};     // 最后一条被折叠的日志的记录头
+        };
+
+        // 调用点：BINARY记录用调用点id，MESSAGE记录用行号和文件名的哈希；
+        // 哈希冲突时内容不同，不会被误折叠
+        static uint64_t SiteKey(const RecordHeader& head, std::string_view body)
+        {
+            if ((RecordKind)head.kind == RecordKind::BINARY)
+                return head.site;
+            size_t file_end = body.find('\0', sizeof(uint32_t));
+            std::string_view where = body.substr(0, file_end == std::string_view::npos ? body.size() : file_end);
+            return (1ull << 63) | std::hash<std::string_view>()(where);
+        }
+
+        // Summarize：输出一条重复次数的提示，文件、行号、等级、线程和时间取自被折叠的日志
+        void Summarize(Site& site, std::string& out)
+        {
+            if (site.repeats == 0)
+                return;
+            std::string file = "?";
+            uint32_t line = 0;
+            std::string_view body(site.body);
+            if ((RecordKind)site.kind == RecordKind::MESSAGE && body.size() > sizeof(line)) {
+                memcpy(&line, body.data(), sizeof(line));
+                size_t end = body.find('\0', sizeof(line));
+                file.assign(body.substr(sizeof(line), end == std::string_view::npos ? std::string_view::npos : end - sizeof(line)));
+            } else if (const CallSite* cs = CallSiteRegistry::Get(site.last.site)) {
+                file = cs->file ? cs->file : "?";
+                line = cs->line;
+            }
+            std::string payload = "last message repeated " + std::to_string(site.repeats) + " times";
+            size_t begin = out.size();
+            EncodeMessage(out, (LogLevel::value)site.last.level, file.c_str(), line, logger_name_, payload.data(), payload.size());
+            RecordHeader head;
+            memcpy(&head, &out[begin], sizeof(head));
+            head.ts_ns = site.last.ts_ns;
+            head.tid = site.last.tid;
+            memcpy(&out[begin], &head, sizeof(head));
+            site.repeats = 0;
+        }
+
+    private:
+        uint64_t window_ns_;                           // 折叠窗口
+        std::string logger_name_;                      // 日志器名
+        std::unordered_map<uint64_t, Site> sites_;     // 各调用点的上一条日志
+    };
+} // namespace mylog
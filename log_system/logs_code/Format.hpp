@@ -0,0 +1,178 @@
+/*类型安全的日志格式化设计*/
+#pragma once
+#include <charconv> // 用于std::to_chars，无分配地把数字转换为字符串
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace mylog {
+    // KeyValue：结构化日志的一个字段，键必须是字符串字面量，值支持的类型与{}参数一致
+    // 字段不占用格式串中的{}，文本输出时以" 键=值"追加在信息体之后，JSON输出时作为对象的成员
+    // 只保存值的引用，必须在日志语句中直接构造，例：MYLOG_INFO(logger, "download done", mylog::KV("bytes", len));
+    template <typename T>
+    struct KeyValue {
+        const char* key;
+        const T& value;
+    };
+
+    template <typename T>
+    KeyValue<T> KV(const char* key, const T& value) { return KeyValue<T>{key, value}; }
+
+namespace fmt {
+    template <typename T>
+    struct IsKeyValue : std::false_type {};
+    template <typename T>
+    struct IsKeyValue<KeyValue<T>> : std::true_type {};
+
+    // 参数中占用{}的个数，结构化字段不计入
+    template <typename Tuple>
+    struct PositionalCount;
+    template <typename... Args>
+    struct PositionalCount<std::tuple<Args...>>
+        : std::integral_constant<size_t, (size_t(0) + ... + (IsKeyValue<std::decay_t<Args>>::value ? 0 : 1))> {};
+
+    // 编译期统计格式串中{}占位符的个数，{{和}}分别表示字面的{和}
+    constexpr size_t CountPlaceholders(const char* s)
+    {
+        size_t n = 0;
+        for (; *s; ++s)
+        {
+            if (s[0] == '{' && s[1] == '{') ++s;
+            else if (s[0] == '}' && s[1] == '}') ++s;
+            else if (s[0] == '{' && s[1] == '}') { ++n; ++s; }
+        }
+        return n;
+    }
+
+    template <typename T>
+    struct AlwaysFalse : std::false_type {};
+
+    // 把一个参数按类型追加到out，整数和浮点数用to_chars转换，不产生堆分配
+    template <typename T>
+    void AppendArg(std::string& out, const T& v)
+    {
+        using D = std::decay_t<T>;
+        if constexpr (std::is_same_v<D, bool>) {
+            out.append(v ? "true" : "false");
+        } else if constexpr (std::is_same_v<D, char>) {
+            out.push_back(v);
+        } else if constexpr (std::is_integral_v<D> || std::is_floating_point_v<D>) {
+            char buf[32];
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, r.ptr - buf);
+        } else if constexpr (std::is_enum_v<D>) {
+            AppendArg(out, static_cast<std::underlying_type_t<D>>(v));
+        } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+            if constexpr (std::is_array_v<T>) // 字符数组（如字符串字面量）不会是空指针
+                out.append(v);
+            else
+                out.append(v ? v : "(null)");
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            std::string_view sv = v;
+            out.append(sv.data(), sv.size());
+        } else if constexpr (std::is_pointer_v<D>) {
+            char buf[32];
+            auto r = std::to_chars(buf, buf + sizeof(buf), reinterpret_cast<uintptr_t>(v), 16);
+            out.append("0x").append(buf, r.ptr - buf);
+        } else {
+            static_assert(AlwaysFalse<T>::value, "mylog: unsupported log argument type");
+        }
+    }
+
+    // EscapeJson：把s按JSON字符串的规则转义写入out（不含两侧引号），out至少要有6倍s.size()字节，返回写入的字节数
+    // 只转义引号、反斜杠和控制字符，其他字节（包括UTF-8多字节字符）原样输出
+    inline size_t EscapeJson(char* out, std::string_view s)
+    {
+        static const char hex[] = "0123456789abcdef";
+        char* p = out;
+        for (unsigned char c : s) {
+            if (c == '"' || c == '\\') {
+                *p++ = '\\';
+                *p++ = c;
+            } else if (c >= 0x20) {
+                *p++ = c;
+            } else if (c == '\n') {
+                *p++ = '\\'; *p++ = 'n';
+            } else if (c == '\t') {
+                *p++ = '\\'; *p++ = 't';
+            } else if (c == '\r') {
+                *p++ = '\\'; *p++ = 'r';
+            } else {
+                memcpy(p, "\\u00", 4);
+                p[4] = hex[c >> 4];
+                p[5] = hex[c & 0xf];
+                p += 6;
+            }
+        }
+        return p - out;
+    }
+
+    // AppendJson：把s转义后加上引号追加到out
+    inline void AppendJson(std::string& out, std::string_view s)
+    {
+        size_t old = out.size();
+        out.resize(old + 2 + 6 * s.size());
+        out[old] = '"';
+        size_t n = EscapeJson(&out[old + 1], s);
+        out[old + 1 + n] = '"';
+        out.resize(old + 2 + n);
+    }
+
+    // AppendField：文本形式的结构化字段，" 键=值"；其他参数不输出
+    template <typename T>
+    void AppendField(std::string& out, const T& arg)
+    {
+        if constexpr (IsKeyValue<T>::value) {
+            out.push_back(' ');
+            out.append(arg.key).push_back('=');
+            AppendArg(out, arg.value);
+        }
+    }
+
+    // 追加格式串中下一个{}之前的字面内容，返回{}之后的位置；没有更多占位符时返回nullptr
+    inline const char* AppendLiteral(std::string& out, const char* p)
+    {
+        while (*p)
+        {
+            const char* start = p;
+            while (*p && *p != '{' && *p != '}') ++p;
+            out.append(start, p - start);
+            if (!*p) break;
+            if (p[0] == '{' && p[1] == '}') return p + 2;
+            out.push_back(*p); // {{ 或 }} 转义，以及落单的括号原样输出
+            p += (p[1] == p[0]) ? 2 : 1;
+        }
+        return nullptr;
+    }
+
+    // FormatTo：按{}占位符把参数依次格式化追加到out，结构化字段跳过占位符，最后依次追加
+    // 占位符多于参数时多余的{}原样输出，参数多于占位符时多余参数被忽略（使用宏时在编译期就会报错）
+    template <typename... Args>
+    void FormatTo(std::string& out, const char* format, const Args&... args)
+    {
+        const char* p = format;
+        auto one = [&](const auto& arg) {
+            if constexpr (!IsKeyValue<std::decay_t<decltype(arg)>>::value) {
+                if (!p) return;
+                p = AppendLiteral(out, p);
+                if (p) AppendArg(out, arg);
+            }
+        };
+        (void)one; // 没有参数时lambda不会被调用
+        (one(args), ...);
+        while (p && (p = AppendLiteral(out, p)))
+            out.append("{}");
+        (AppendField(out, args), ...);
+    }
+} // namespace fmt
+} // namespace mylog
+
+// 编译期检查格式串的占位符个数与参数个数（不含结构化字段）是否一致，格式串必须是字符串字面量
+#define MYLOG_CHECK_FORMAT(format, ...)                                                          \
+    static_assert(::mylog::fmt::CountPlaceholders(format) ==                                    \
+                      ::mylog::fmt::PositionalCount<decltype(std::make_tuple(__VA_ARGS__))>::value, \
+                  "mylog: placeholder count in log format does not match argument count")
@@ -1,6 +1,13 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
+// 编译期最低日志等级：低于该等级的MYLOG_*宏和Debug/Info等宏在编译期被去掉，参数不会求值
+// 取值与LogLevel::value一致：0-DEBUG 1-INFO 2-WARN 3-ERROR 4-FATAL，编译时用-DMYLOG_MIN_LEVEL=1等指定
+#ifndef MYLOG_MIN_LEVEL
+#define MYLOG_MIN_LEVEL 0
+#endif
+
 namespace mylog {
 class LogLevel {
    public:
@@ -24,5 +31,16 @@ class LogLevel {
         }
         return "UNKNOW";
     }
+
+    // 等级掩码：第i位表示等级值为i的日志，用于刷新器按等级接收日志
+    static constexpr uint32_t kAllLevels = 0x1f;
+    static constexpr uint32_t Bit(value level) { return 1u << (int)level; }
+    // [min, max]范围内所有等级的掩码，例如Range(value::ERROR, value::FATAL)
+    static constexpr uint32_t Range(value min, value max) {
+        uint32_t mask = 0;
+        for (int l = (int)min; l <= (int)max; ++l)
+            mask |= 1u << l;
+        return mask;
+    }
 };
 }  // namespace mylog
@@ -0,0 +1,137 @@
+/*滚动日志文件的后台压缩设计*/
+#pragma once
+#include <atomic> // 统计压缩前后的字节数
+#include <condition_variable> // 唤醒压缩线程
+#include <cstdio> // 用于rename/remove
+#include <cstring> // 用于memcpy
+#include <deque> // 待压缩文件队列
+#include <mutex> // 保护队列
+#include <string>
+#include <thread> // 后台压缩线程
+#include "LogFlush.hpp" // RollHandler
+#include "Util.hpp" // 读取文件内容
+#include "../../src/server/bundle.h" // 复用服务端的bundle压缩库，使用时需要链接-lbundle
+
+namespace mylog {
+    // 压缩后文件的文件头，之后紧跟bundle::pack的输出
+    struct CompressedSegmentHeader {
+        char magic[4];     // 固定为"MLGZ"
+        uint32_t format;   // bundle压缩格式，如bundle::LZ4
+        uint64_t raw_size; // 压缩前的大小
+    };
+
+    // BundleCompressor：RollFileFlush的滚动处理器，把写满关闭的日志文件交给后台线程压缩
+    // 压缩结果写为原文件名加.bdl后缀，成功后删除原文件；写日志的线程只是把文件名放入队列
+    // 刷新器析构时最后一个文件也会放入队列，压缩器析构前压缩完队列中的所有文件
+    // 用法：BuildLoggerFlush<RollFileFlush>("./logfile/RollFile_log", 1024 * 1024, std::make_shared<BundleCompressor>());
+    class BundleCompressor : public RollHandler
+    {
+    public:
+        using ptr = std::shared_ptr<BundleCompressor>;
+        static constexpr const char* kSuffix = ".bdl"; // 压缩文件后缀
+
+        explicit BundleCompressor(unsigned format = bundle::LZ4)
+            : format_(format), thread_(&BundleCompressor::ThreadEntry, this) {}
+
+        // 析构时压缩完队列中剩余的文件再退出
+        ~BundleCompressor()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                stop_ = true;
+            }
+            cond_.notify_one();
+            thread_.join();
+        }
+
+        void OnRolled(const std::string& filename) override
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                queue_.push_back(filename);
+            }
+            cond_.notify_one();
+        }
+
+        // 压缩前后的总字节数，可用于观察压缩比
+        size_t RawBytes() const { return raw_bytes_.load(std::memory_order_relaxed); }
+        size_t CompressedBytes() const { return compressed_bytes_.load(std::memory_order_relaxed); }
+
+        // Decompress：读取压缩后的日志文件，还原出原始内容
+        static bool Decompress(const std::string& filename, std::string* content)
+        {
+            std::string body;
+            if (Util::File().GetContent(&body, filename) == false)
+                return false;
+            CompressedSegmentHeader head;
+            if (body.size() < sizeof(head) || memcmp(body.data(), "MLGZ", 4) != 0) {
+                std::cout << __FILE__ << __LINE__ << "not a compressed log file: " << filename << std::endl;
+                return false;
+            }
+            memcpy(&head, body.data(), sizeof(head));
+            *content = bundle::unpack(body.substr(sizeof(head)));
+            return content->size() == head.raw_size;
+        }
+
+    private:
+        void ThreadEntry()
+        {
+            while (true)
+            {
+                std::string filename;
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                    if (queue_.empty())
+                        return;
+                    filename = std::move(queue_.front());
+                    queue_.pop_front();
+                }
+                Compress(filename);
+            }
+        }
+
+        // 先写临时文件再rename，进程中途退出时不会留下不完整的压缩文件，原文件仍在
+        void Compress(const std::string& filename)
+        {
+            std::string content;
+            if (Util::File().GetContent(&content, filename) == false)
+                return;
+            std::string packed = bundle::pack(format_, content);
+            if (packed.empty()) {
+                std::cout << __FILE__ << __LINE__ << "compress log file failed: " << filename << std::endl;
+                return;
+            }
+            CompressedSegmentHeader head = {{'M', 'L', 'G', 'Z'}, format_, content.size()};
+            std::string tmp = filename + kSuffix + ".tmp";
+            FILE* fp = fopen(tmp.c_str(), "wb");
+            if (fp == NULL) {
+                std::cout << __FILE__ << __LINE__ << "open compressed log file failed" << std::endl;
+                perror(NULL);
+                return;
+            }
+            bool ok = fwrite(&head, sizeof(head), 1, fp) == 1 &&
+                fwrite(packed.data(), 1, packed.size(), fp) == packed.size();
+            ok = (fclose(fp) == 0) && ok;
+            if (!ok || rename(tmp.c_str(), (filename + kSuffix).c_str()) != 0) {
+                std::cout << __FILE__ << __LINE__ << "write compressed log file failed" << std::endl;
+                perror(NULL);
+                remove(tmp.c_str());
+                return;
+            }
+            remove(filename.c_str());
+            raw_bytes_.fetch_add(content.size(), std::memory_order_relaxed);
+            compressed_bytes_.fetch_add(sizeof(head) + packed.size(), std::memory_order_relaxed);
+        }
+
+    private:
+        unsigned format_; // bundle压缩格式
+        std::mutex mtx_; // 保护queue_和stop_
+        std::condition_variable cond_; // 有文件待压缩时唤醒压缩线程
+        std::deque<std::string> queue_; // 待压缩的文件
+        bool stop_ = false; // 是否退出
+        std::atomic<size_t> raw_bytes_{0};
+        std::atomic<size_t> compressed_bytes_{0};
+        std::thread thread_; // 压缩线程，最后初始化
+    };
+} // namespace mylog
@@ -1,8 +1,20 @@
+#pragma once
 #include <cassert> // 用于断言
 #include <fstream> // 用于文件流操作
 #include <memory> // 用于智能指针
 #include <unistd.h> // 用于fsync函数
+#include <algorithm> // 用于std::min
+#include <atomic> // 用于刷新器的统计计数
+#include <vector> // 用于保存iovec
+#include <climits> // 用于IOV_MAX
+#include <fcntl.h> // 用于open和fallocate
+#include <sys/uio.h> // 用于pwritev
+#include <sys/mman.h> // 用于mmap和msync
+#include <cstring> // 用于memcpy
 #include "Util.hpp" // 包含mylog::Util::File和mylog::Util::Date，以及mylog::Util::JsonData
+#include "SyncPolicy.hpp" // 按时间/字节分组同步磁盘
+#include "Pattern.hpp" // 刷新器自己的输出格式
+#include "Level.hpp" // 刷新器接收的等级掩码
 
 // 声明外部全局变量，用于访问日志配置数据
 extern mylog::Util::JsonData* g_conf_data;
@@ -16,6 +28,34 @@ namespace mylog {
         virtual ~LogFlush() {} // 虚析构函数，确保正确释放派生类资源
         // 纯虚函数：不同的写文件方式（如stdout, 文件, 滚动文件）需要实现自己的Flush逻辑
         virtual void Flush(const char* data, size_t len) = 0;
+        // 一次写入多段数据，默认逐段调用Flush，支持向量写的刷新器可以重写为一次系统调用
+        virtual void FlushV(const struct iovec* iov, int iovcnt)
+        {
+            for (int i = 0; i < iovcnt; ++i)
+                Flush((const char*)iov[i].iov_base, iov[i].iov_len);
+        }
+        // 是否接收延迟格式化日志器的原始二进制记录，默认接收格式化后的文本
+        virtual bool NeedRaw() const { return false; }
+        // 同步尚未落盘的数据：force为true时立即同步（如批次中有ERROR/FATAL），
+        // 为false时只在距上次同步超过sync_interval时同步，由消费者线程空闲时调用
+        virtual void Sync(bool /*force*/) {}
+        // 同步磁盘的次数、覆盖字节数和耗时统计，不同步磁盘的刷新器返回全0
+        virtual SyncStats GetSyncStats() const { return SyncStats(); }
+        // 刷新器自己的持久化策略，覆盖配置文件中的flush_log/sync_interval/sync_bytes/sync_on_error，
+        // 例如ERROR/FATAL文件每批同步，DEBUG/INFO滚动文件不同步；只能在交给日志器之前设置
+        virtual void SetSyncPolicy(const SyncPolicy& /*policy*/) {}
+        // 刷新器实际使用的持久化策略，不同步磁盘的刷新器返回mode为0的策略
+        virtual SyncPolicy GetSyncPolicy() const { return SyncPolicy(); }
+        // 刷新器自己的输出格式，为空时使用日志器的格式；设置后日志器由消费者线程按各刷新器的格式输出
+        void SetPattern(Pattern::ptr pattern) { pattern_ = std::move(pattern); }
+        const Pattern::ptr& GetPattern() const { return pattern_; }
+        // 刷新器接收的等级掩码（见LogLevel::Bit/Range），默认接收所有等级；设置后日志器按每条记录的等级路由
+        void SetLevelMask(uint32_t mask) { level_mask_ = mask; }
+        uint32_t GetLevelMask() const { return level_mask_; }
+
+    protected:
+        Pattern::ptr pattern_; // 输出格式
+        uint32_t level_mask_ = LogLevel::kAllLevels; // 接收的等级
     };
 
     // StdoutFlush是LogFlush的派生类，将日志刷新到标准输出
@@ -46,29 +86,88 @@ namespace mylog {
                 perror(NULL);
             }
         }
+        // 关闭文件：不fflush的持久化策略下stdio缓冲区中还有数据，日志器析构后必须落地
+        ~FileFlush()
+        {
+            if (fs_ == NULL)
+                return;
+            fflush(fs_);
+            if (sync_.HasUnsynced())
+                DoSync(); // 关闭前同步尚未落盘的部分
+            fclose(fs_);
+        }
         // 实现Flush方法，将数据写入文件
         void Flush(const char* data, size_t len) override {
-            fwrite(data, 1, len, fs_); // 将数据写入文件
+            struct iovec iov = {(void*)data, len};
+            FlushV(&iov, 1);
+        }
+
+        // 多段数据逐段写入stdio缓冲区，整批只按flush_log刷新和同步一次
+        void FlushV(const struct iovec* iov, int iovcnt) override {
+            size_t len = 0;
+            for (int i = 0; i < iovcnt; ++i) {
+                fwrite(iov[i].iov_base, 1, iov[i].iov_len, fs_); // 将数据写入文件
+                len += iov[i].iov_len;
+            }
             if (ferror(fs_)) { // 检查写入错误
                 std::cout << __FILE__ << __LINE__ << "write log file failed" << std::endl;
                 perror(NULL);
             }
-            // 根据配置文件中的flush_log设置，决定何时同步到磁盘
-            if (g_conf_data->flush_log == 1) { // 立即执行fflush (缓冲区刷新到OS缓存)
+            // 根据持久化策略（默认来自配置文件中的flush_log），决定何时同步到磁盘
+            if (sync_.Policy().mode == 1) { // 立即执行fflush (缓冲区刷新到OS缓存)
                 if (fflush(fs_) == EOF) {
                     std::cout << __FILE__ << __LINE__ << "fflush file failed" << std::endl;
                     perror(NULL);
                 }
             }
-            else if (g_conf_data->flush_log == 2) { // 执行fflush和fsync (OS缓存刷新到物理磁盘)
+            else if (sync_.Policy().mode == 2) { // 执行fflush，再按持久化策略fdatasync (OS缓存刷新到物理磁盘)
                 fflush(fs_);
-                fsync(fileno(fs_));
+                if (sync_.OnWrite(len))
+                    DoSync();
             }
         }
 
+        void Sync(bool force) override
+        {
+            if (fs_ != NULL && (force ? sync_.HasUnsynced() : sync_.Due()))
+                DoSync();
+        }
+
+        SyncStats GetSyncStats() const override { return sync_.Stats(); }
+        void SetSyncPolicy(const SyncPolicy& policy) override { sync_.SetPolicy(policy); }
+        SyncPolicy GetSyncPolicy() const override { return sync_.Policy(); }
+
+    private:
+        void DoSync()
+        {
+            sync_.Run([this]() { fdatasync(fileno(fs_)); });
+        }
+
     private:
         std::string filename_; // 日志文件名
         FILE* fs_ = NULL; // 文件指针
+        SyncController sync_; // 持久化策略
+    };
+
+    // BinaryFileFlush：把延迟格式化日志器的原始二进制记录直接写入文件，由离线解码工具还原为文本
+    // 用于普通日志器时写入的就是文本
+    class BinaryFileFlush : public FileFlush
+    {
+    public:
+        using ptr = std::shared_ptr<BinaryFileFlush>;
+        using FileFlush::FileFlush;
+        bool NeedRaw() const override { return true; }
+    };
+
+    // RollHandler：滚动日志文件关闭之后的处理器，例如后台压缩（见LogCompress.hpp）
+    // OnRolled在写日志的线程中调用，实现必须立即返回，不能在其中做耗时操作
+    // 刷新器析构时正在写的最后一个文件关闭后也交给OnRolled，不会留下一个未处理的文件
+    class RollHandler
+    {
+    public:
+        using ptr = std::shared_ptr<RollHandler>;
+        virtual ~RollHandler() {}
+        virtual void OnRolled(const std::string& filename) = 0;
     };
 
     // RollFileFlush是LogFlush的派生类，实现日志文件滚动功能
@@ -76,39 +175,79 @@ namespace mylog {
     {
     public:
         using ptr = std::shared_ptr<RollFileFlush>; // 定义智能指针类型
-        // 构造函数：接收文件名基础和最大文件大小
-        RollFileFlush(const std::string& filename, size_t max_size)
-            : max_size_(max_size), basename_(filename)
+        // 构造函数：接收文件名基础和最大文件大小，handler不为空时每个写满关闭的文件都交给它处理
+        RollFileFlush(const std::string& filename, size_t max_size, RollHandler::ptr handler = nullptr)
+            : max_size_(max_size), basename_(filename), handler_(handler)
         {
             // 创建日志文件所在的目录
             mylog::Util::File::CreateDirectory(mylog::Util::File::Path(filename));
         }
 
+        // 关闭当前文件，与FileFlush相同；最后一个文件同样交给处理器
+        ~RollFileFlush()
+        {
+            if (fs_ == NULL)
+                return;
+            fflush(fs_);
+            if (sync_.HasUnsynced())
+                DoSync();
+            fclose(fs_);
+            if (handler_)
+                handler_->OnRolled(filename_);
+        }
+
         // 实现Flush方法，将数据写入文件，并在文件大小达到阈值时进行滚动
         void Flush(const char* data, size_t len) override
+        {
+            struct iovec iov = {(void*)data, len};
+            FlushV(&iov, 1);
+        }
+
+        // 一批数据写入同一个文件，写完后再检查是否需要滚动
+        void FlushV(const struct iovec* iov, int iovcnt) override
         {
             InitLogFile(); // 检查是否需要滚动，并确保文件打开
             // 向当前日志文件写入内容
-            fwrite(data, 1, len, fs_);
+            size_t len = 0;
+            for (int i = 0; i < iovcnt; ++i) {
+                fwrite(iov[i].iov_base, 1, iov[i].iov_len, fs_);
+                len += iov[i].iov_len;
+            }
 			if (ferror(fs_)) { // 检查写入错误
                 std::cout << __FILE__ << __LINE__ << "write log file failed" << std::endl;
                 perror(NULL);
             }
             cur_size_ += len; // 更新当前文件大小
             // 根据配置决定刷新到磁盘的时机，与FileFlush相同
-            if (g_conf_data->flush_log == 1) {
+            if (sync_.Policy().mode == 1) {
                 if (fflush(fs_)) {
                     std::cout << __FILE__ << __LINE__ << "fflush file failed" << std::endl;
                     perror(NULL);
                 }
             }
-            else if (g_conf_data->flush_log == 2) {
+            else if (sync_.Policy().mode == 2) {
                 fflush(fs_);
-                fsync(fileno(fs_));
+                if (sync_.OnWrite(len))
+                    DoSync();
             }
         }
 
+        void Sync(bool force) override
+        {
+            if (fs_ != NULL && (force ? sync_.HasUnsynced() : sync_.Due()))
+                DoSync();
+        }
+
+        SyncStats GetSyncStats() const override { return sync_.Stats(); }
+        void SetSyncPolicy(const SyncPolicy& policy) override { sync_.SetPolicy(policy); }
+        SyncPolicy GetSyncPolicy() const override { return sync_.Policy(); }
+
     private:
+        void DoSync()
+        {
+            sync_.Run([this]() { fdatasync(fileno(fs_)); });
+        }
+
         // 初始化或滚动日志文件
         void InitLogFile()
         {
@@ -116,11 +255,15 @@ namespace mylog {
             if (fs_ == NULL || cur_size_ >= max_size_)
             {
                 if (fs_ != NULL) {
+                    if (sync_.HasUnsynced())
+                        DoSync(); // 关闭前同步尚未落盘的部分，之后再也没有机会
                     fclose(fs_); // 关闭当前文件（如果已打开）
                     fs_ = NULL;
+                    if (handler_)
+                        handler_->OnRolled(filename_); // 交给处理器，例如后台压缩
                 }
-                std::string filename = CreateFilename(); // 创建新的文件名
-                fs_ = fopen(filename.c_str(), "ab"); // 打开新文件
+                filename_ = CreateFilename(); // 创建新的文件名
+                fs_ = fopen(filename_.c_str(), "ab"); // 打开新文件
                 if (fs_ == NULL) {
                     std::cout << __FILE__ << __LINE__ << "open file failed" << std::endl;
                     perror(NULL);
@@ -131,11 +274,18 @@ namespace mylog {
 
         // 构建滚动日志文件名称（包含时间戳和计数器）
         std::string CreateFilename()
+        {
+            return RollFilename(basename_, cnt_++);
+        }
+
+    public:
+        // 拼接年月日时分秒和计数器，RawFileFlush、MmapFileFlush滚动时使用相同的命名方式
+        static std::string RollFilename(const std::string& basename, size_t cnt)
         {
             time_t time_ = mylog::Util::Date::Now(); // 获取当前时间戳
             struct tm t;
             localtime_r(&time_, &t); // 转换为本地时间
-            std::string filename = basename_; // 使用基础文件名
+            std::string filename = basename; // 使用基础文件名
             // 拼接年月日时分秒和计数器
             filename += std::to_string(t.tm_year + 1900);
             filename += std::to_string(t.tm_mon + 1);
@@ -143,7 +293,7 @@ namespace mylog {
             filename += std::to_string(t.tm_hour + 1);
             filename += std::to_string(t.tm_min + 1);
             filename += std::to_string(t.tm_sec + 1) + '-' +
-                std::to_string(cnt_++) + ".log"; // 拼接计数器和.log后缀
+                std::to_string(cnt) + ".log"; // 拼接计数器和.log后缀
 			return filename; // 完整文件名 示例：20250325123456-1.log
         }
 
@@ -152,7 +302,347 @@ namespace mylog {
         size_t cur_size_ = 0; // 当前文件大小
         size_t max_size_; // 最大文件大小，超过则滚动
         std::string basename_; // 日志文件名的基础部分
+        std::string filename_; // 当前日志文件名
+        RollHandler::ptr handler_; // 滚动文件关闭后的处理器，可为空
         FILE* fs_ = NULL; // 文件指针
+        SyncController sync_; // 持久化策略
+    };
+
+    // RawFileFlush：直接使用文件描述符的高吞吐文件刷新器
+    // 不经过stdio缓冲区，减少一次内存拷贝；多段数据用pwritev一次系统调用写入
+    // segment_size大于0时按该大小滚动，并用fallocate预先分配整个分段的磁盘空间，避免文件逐块增长
+    class RawFileFlush : public LogFlush
+    {
+    public:
+        using ptr = std::shared_ptr<RawFileFlush>;
+
+        // 写入统计，可在任意线程读取
+        struct Stats {
+            size_t bytes = 0;    // 写入的字节数
+            size_t syscalls = 0; // write/pwritev系统调用次数
+            size_t batches = 0;  // Flush/FlushV调用次数
+            size_t rolls = 0;    // 滚动次数
+        };
+
+        // segment_size为0时写入单个文件filename，否则filename作为滚动文件名的基础部分
+        RawFileFlush(const std::string& filename, size_t segment_size = 0, RollHandler::ptr handler = nullptr)
+            : basename_(filename), segment_size_(segment_size), handler_(handler)
+        {
+            mylog::Util::File::CreateDirectory(mylog::Util::File::Path(filename));
+        }
+
+        // 滚动模式下最后一个分段同样交给处理器，单文件模式下次启动还要追加，不交给处理器
+        ~RawFileFlush()
+        {
+            bool opened = fd_ >= 0;
+            CloseFile();
+            if (opened && segment_size_ && handler_)
+                handler_->OnRolled(filename_);
+        }
+
+        void Flush(const char* data, size_t len) override
+        {
+            struct iovec iov = {(void*)data, len};
+            FlushV(&iov, 1);
+        }
+
+        void FlushV(const struct iovec* iov, int iovcnt) override
+        {
+            size_t total = 0;
+            for (int i = 0; i < iovcnt; ++i)
+                total += iov[i].iov_len;
+            if (total == 0)
+                return;
+            OpenFile();
+            if (fd_ < 0)
+                return;
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            size_t before = offset_;
+            WriteAll(iov, iovcnt);
+            // 与FileFlush相同，没有stdio缓冲区所以flush_log为1时无需处理
+            if (sync_.OnWrite(offset_ - before))
+                DoSync();
+        }
+
+        void Sync(bool force) override
+        {
+            if (fd_ >= 0 && (force ? sync_.HasUnsynced() : sync_.Due()))
+                DoSync();
+        }
+
+        SyncStats GetSyncStats() const override { return sync_.Stats(); }
+        void SetSyncPolicy(const SyncPolicy& policy) override { sync_.SetPolicy(policy); }
+        SyncPolicy GetSyncPolicy() const override { return sync_.Policy(); }
+
+        Stats GetStats() const
+        {
+            Stats st;
+            st.bytes = bytes_.load(std::memory_order_relaxed);
+            st.syscalls = syscalls_.load(std::memory_order_relaxed);
+            st.batches = batches_.load(std::memory_order_relaxed);
+            st.rolls = rolls_.load(std::memory_order_relaxed);
+            return st;
+        }
+
+    private:
+        void DoSync()
+        {
+            sync_.Run([this]() { fdatasync(fd_); });
+        }
+
+        // 按IOV_MAX分组调用pwritev，处理部分写入
+        void WriteAll(const struct iovec* iov, int iovcnt)
+        {
+            iov_.assign(iov, iov + iovcnt);
+            size_t idx = 0;
+            while (idx < iov_.size())
+            {
+                int cnt = (int)std::min(iov_.size() - idx, (size_t)IOV_MAX);
+                ssize_t n = pwritev(fd_, &iov_[idx], cnt, offset_);
+                syscalls_.fetch_add(1, std::memory_order_relaxed);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0) {
+                    std::cout << __FILE__ << __LINE__ << "write log file failed" << std::endl;
+                    perror(NULL);
+                    return;
+                }
+                offset_ += n;
+                bytes_.fetch_add(n, std::memory_order_relaxed);
+                // 跳过已经写完的段，最后一段可能只写了一部分
+                while (n > 0 && idx < iov_.size())
+                {
+                    if ((size_t)n >= iov_[idx].iov_len) {
+                        n -= iov_[idx].iov_len;
+                        ++idx;
+                    } else {
+                        iov_[idx].iov_base = (char*)iov_[idx].iov_base + n;
+                        iov_[idx].iov_len -= n;
+                        n = 0;
+                    }
+                }
+                while (idx < iov_.size() && iov_[idx].iov_len == 0)
+                    ++idx;
+            }
+        }
+
+        // 打开文件，滚动模式下写满一个分段后打开下一个分段
+        void OpenFile()
+        {
+            if (fd_ >= 0 && (segment_size_ == 0 || offset_ < segment_size_))
+                return;
+            if (fd_ >= 0) {
+                CloseFile();
+                rolls_.fetch_add(1, std::memory_order_relaxed);
+                if (handler_)
+                    handler_->OnRolled(filename_);
+            }
+            filename_ = segment_size_ ? RollFileFlush::RollFilename(basename_, cnt_++) : basename_;
+            fd_ = open(filename_.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+            if (fd_ < 0) {
+                std::cout << __FILE__ << __LINE__ << "open log file failed" << std::endl;
+                perror(NULL);
+                return;
+            }
+            offset_ = lseek(fd_, 0, SEEK_END); // 单文件模式下追加到已有内容之后
+            // KEEP_SIZE只分配磁盘块不改变文件大小，读日志时不会看到末尾的空洞
+            if (segment_size_ > offset_)
+                fallocate(fd_, FALLOC_FL_KEEP_SIZE, offset_, segment_size_ - offset_);
+        }
+
+        // 关闭文件前释放预分配但没有用到的磁盘空间
+        void CloseFile()
+        {
+            if (fd_ < 0)
+                return;
+            if (segment_size_)
+                ftruncate(fd_, offset_);
+            if (sync_.HasUnsynced())
+                DoSync(); // 关闭前同步尚未落盘的部分
+            close(fd_);
+            fd_ = -1;
+        }
+
+    private:
+        std::string basename_; // 文件名或滚动文件名的基础部分
+        std::string filename_; // 当前文件名
+        size_t segment_size_; // 分段大小，0表示不滚动
+        RollHandler::ptr handler_; // 滚动文件关闭后的处理器，可为空
+        size_t cnt_ = 1; // 滚动文件计数器
+        int fd_ = -1; // 文件描述符
+        size_t offset_ = 0; // 下一次写入的位置
+        std::vector<struct iovec> iov_; // 处理部分写入时使用的iovec副本
+        std::atomic<size_t> bytes_{0};
+        std::atomic<size_t> syscalls_{0};
+        std::atomic<size_t> batches_{0};
+        std::atomic<size_t> rolls_{0};
+        SyncController sync_; // 持久化策略
+    };
+
+    // MmapFileFlush：把日志直接拷贝到内存映射的分段文件中，写入不需要系统调用
+    // 每个分段创建时预先分配segment_size大小的磁盘空间并整体映射，写满后关闭并映射下一个分段
+    // 拷贝进映射区的数据已经在页缓存中，进程崩溃也不会丢失；按持久化策略用msync同步到磁盘
+    // 进程崩溃时当前分段末尾会留下未写入的0字节，正常关闭或滚动时会截断到实际写入的大小
+    class MmapFileFlush : public LogFlush
+    {
+    public:
+        using ptr = std::shared_ptr<MmapFileFlush>;
+
+        // 写入统计，可在任意线程读取
+        struct Stats {
+            size_t bytes = 0;   // 写入的字节数
+            size_t batches = 0; // Flush/FlushV调用次数
+            size_t rolls = 0;   // 滚动次数
+        };
+
+        // filename作为滚动文件名的基础部分，segment_size向上取整到页大小
+        MmapFileFlush(const std::string& filename, size_t segment_size = 64 * 1024 * 1024, RollHandler::ptr handler = nullptr)
+            : basename_(filename), handler_(handler)
+        {
+            size_t page = sysconf(_SC_PAGESIZE);
+            segment_size_ = (std::max(segment_size, page) + page - 1) / page * page;
+            mylog::Util::File::CreateDirectory(mylog::Util::File::Path(filename));
+        }
+
+        // 最后一个分段截断到实际大小后同样交给处理器
+        ~MmapFileFlush()
+        {
+            bool opened = base_ != nullptr;
+            CloseSegment();
+            if (opened && handler_)
+                handler_->OnRolled(filename_);
+        }
+
+        void Flush(const char* data, size_t len) override
+        {
+            struct iovec iov = {(void*)data, len};
+            FlushV(&iov, 1);
+        }
+
+        void FlushV(const struct iovec* iov, int iovcnt) override
+        {
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            for (int i = 0; i < iovcnt; ++i)
+            {
+                const char* data = (const char*)iov[i].iov_base;
+                size_t len = iov[i].iov_len;
+                while (len > 0)
+                {
+                    if (base_ == nullptr || offset_ == segment_size_)
+                        OpenSegment();
+                    if (base_ == nullptr)
+                        return;
+                    size_t n = std::min(len, segment_size_ - offset_);
+                    memcpy(base_ + offset_, data, n);
+                    offset_ += n;
+                    data += n;
+                    len -= n;
+                    bytes_.fetch_add(n, std::memory_order_relaxed);
+                    if (sync_.OnWrite(n))
+                        DoSync();
+                }
+            }
+            if (sync_.Policy().mode == 1 && base_ != nullptr && offset_ > synced_) { // 与fflush对应，只提交给内核不等待
+                msync(base_ + PageFloor(synced_), offset_ - PageFloor(synced_), MS_ASYNC);
+                synced_ = offset_;
+            }
+        }
+
+        void Sync(bool force) override
+        {
+            if (base_ != nullptr && (force ? sync_.HasUnsynced() : sync_.Due()))
+                DoSync();
+        }
+
+        SyncStats GetSyncStats() const override { return sync_.Stats(); }
+        void SetSyncPolicy(const SyncPolicy& policy) override { sync_.SetPolicy(policy); }
+        SyncPolicy GetSyncPolicy() const override { return sync_.Policy(); }
+
+        Stats GetStats() const
+        {
+            Stats st;
+            st.bytes = bytes_.load(std::memory_order_relaxed);
+            st.batches = batches_.load(std::memory_order_relaxed);
+            st.rolls = rolls_.load(std::memory_order_relaxed);
+            return st;
+        }
+
+    private:
+        // 只同步上次同步之后写入的页，msync要求起始地址按页对齐
+        void DoSync()
+        {
+            size_t begin = PageFloor(synced_);
+            sync_.Run([&]() {
+                if (msync(base_ + begin, offset_ - begin, MS_SYNC) < 0)
+                    perror("msync error: ");
+            });
+            synced_ = offset_;
+        }
+
+        size_t PageFloor(size_t off) const
+        {
+            static const size_t page = sysconf(_SC_PAGESIZE);
+            return off / page * page;
+        }
+
+        // 关闭当前分段（如果有），创建并映射下一个分段
+        void OpenSegment()
+        {
+            if (base_ != nullptr) {
+                CloseSegment();
+                rolls_.fetch_add(1, std::memory_order_relaxed);
+                if (handler_)
+                    handler_->OnRolled(filename_);
+            }
+            filename_ = RollFileFlush::RollFilename(basename_, cnt_++);
+            fd_ = open(filename_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd_ < 0) {
+                std::cout << __FILE__ << __LINE__ << "open log file failed" << std::endl;
+                perror(NULL);
+                return;
+            }
+            // 映射区必须有对应的文件内容，用fallocate真正分配磁盘块，磁盘满时在这里失败而不是写入时收到SIGBUS
+            int err = posix_fallocate(fd_, 0, segment_size_);
+            void* addr = err == 0 ? mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0) : MAP_FAILED;
+            if (addr == MAP_FAILED) {
+                std::cout << __FILE__ << __LINE__ << "map log file failed: " << strerror(err ? err : errno) << std::endl;
+                close(fd_);
+                fd_ = -1;
+                return;
+            }
+            base_ = (char*)addr;
+            offset_ = 0;
+            synced_ = 0;
+        }
+
+        // 解除映射，把文件截断到实际写入的大小
+        void CloseSegment()
+        {
+            if (base_ == nullptr)
+                return;
+            if (sync_.HasUnsynced())
+                DoSync(); // 关闭前同步尚未落盘的部分
+            munmap(base_, segment_size_);
+            base_ = nullptr;
+            ftruncate(fd_, offset_);
+            close(fd_);
+            fd_ = -1;
+        }
+
+    private:
+        std::string basename_; // 滚动文件名的基础部分
+        std::string filename_; // 当前分段文件名
+        size_t segment_size_; // 分段大小，页大小的整数倍
+        RollHandler::ptr handler_; // 滚动文件关闭后的处理器，可为空
+        size_t cnt_ = 1; // 滚动文件计数器
+        int fd_ = -1; // 当前分段的文件描述符
+        char* base_ = nullptr; // 当前分段的映射地址
+        size_t offset_ = 0; // 下一次写入的位置
+        size_t synced_ = 0; // 已同步到的位置
+        std::atomic<size_t> bytes_{0};
+        std::atomic<size_t> batches_{0};
+        std::atomic<size_t> rolls_{0};
+        SyncController sync_; // 持久化策略
     };
 
     // LogFlushFactory提供静态方法来创建不同类型的LogFlush实例
@@ -172,6 +662,8 @@ namespace mylog {
 	// LogFlushFactory创造实例
 	// 创建FileFlush实例，传入日志文件名
 	// LogFlushFactory::CreateLog<RollFileFlush>("log.txt", 1024 * 1024) 创建RollFileFlush实例，传入日志文件名和最大文件大小
+	// LogFlushFactory::CreateLog<RawFileFlush>("log", 64 * 1024 * 1024) 创建RawFileFlush实例，按64MB预分配并滚动
+	// LogFlushFactory::CreateLog<MmapFileFlush>("log", 64 * 1024 * 1024) 创建MmapFileFlush实例，按64MB映射并滚动
 	//// 创建StdoutFlush实例
 	//static std::shared_ptr<LogFlush> CreateStdoutFlush()
 	//{
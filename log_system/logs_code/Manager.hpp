@@ -1,6 +1,9 @@
 #include<unordered_map> // 用于存储日志器的哈希表
 #include"AsyncLogger.hpp" // 包含AsyncLogger及其Builder
+#include <atomic> // 用于原子地替换日志器表快照
+#include <memory> // 用于std::unique_ptr
 #include <mutex> // 用于互斥锁，保护单例和map访问
+#include <vector> // 保存旧快照
 
 namespace mylog {
     // LoggerManager类：通过单例对象对日志器进行管理 (懒汉模式)
@@ -17,34 +20,44 @@ namespace mylog {
         // 检查指定名称的日志器是否存在
         bool LoggerExist(const std::string& name)
         {
-            std::unique_lock<std::mutex> lock(mtx_); // 加锁保护对loggers_的访问
-            auto it = loggers_.find(name); // 在哈希表中查找
-            if (it == loggers_.end()) // 如果找到，返回true，否则返回false
-                return false;
-            return true;
+            return FindLogger(name) != nullptr;
         }
 
         // 添加一个日志器实例
         // 使用右值引用&&接受rvalue，支持移动语义，提高效率
+        // 写者之间加锁：复制当前快照、插入新日志器后整体替换，读者始终看到完整的快照
         void AddLogger(const AsyncLogger::ptr&& AsyncLogger)
         {
-            if (LoggerExist(AsyncLogger->Name())) // 如果同名日志器已存在，则不添加
+            std::unique_lock<std::mutex> lock(mtx_); // 只保护写者之间的并发修改
+            const LoggerMap* old = loggers_.load(std::memory_order_acquire);
+            if (old->count(AsyncLogger->Name())) // 如果同名日志器已存在，则不添加
                 return;
-            std::unique_lock<std::mutex> lock(mtx_); // 加锁保护对loggers_的修改
-            // 将日志器添加到哈希表中，键为日志器名称，值为日志器智能指针
-            loggers_.insert(std::make_pair(AsyncLogger->Name(), AsyncLogger));
+            std::unique_ptr<LoggerMap> next(new LoggerMap(*old));
+            // 将日志器添加到新快照中，键为日志器名称，值为日志器智能指针
+            next->insert(std::make_pair(AsyncLogger->Name(), AsyncLogger));
+            retired_.emplace_back(old); // 读者可能仍在访问旧快照，保留到管理器析构时再释放
+            loggers_.store(next.release(), std::memory_order_release);
         }
 
-        // 根据名称获取日志器实例
+        // 根据名称获取日志器实例，无锁读取当前快照
         AsyncLogger::ptr GetLogger(const std::string& name)
         {
-            std::unique_lock<std::mutex> lock(mtx_); // 加锁保护对loggers_的访问
-            auto it = loggers_.find(name);
-            if (it == loggers_.end()) // 如果未找到，返回空智能指针
+            const LoggerMap* loggers = loggers_.load(std::memory_order_acquire);
+            auto it = loggers->find(name);
+            if (it == loggers->end()) // 如果未找到，返回空智能指针
                 return AsyncLogger::ptr(); // AsyncLogger::ptr() 等同于 nullptr
             return it->second; // 返回找到的日志器智能指针
         }
 
+        // 根据名称获取日志器的裸指针，不增加引用计数
+        // 日志器一旦添加就不会被移除，指针在程序运行期间一直有效，供MYLOG_LOGGER宏缓存
+        AsyncLogger* FindLogger(const std::string& name)
+        {
+            const LoggerMap* loggers = loggers_.load(std::memory_order_acquire);
+            auto it = loggers->find(name);
+            return it == loggers->end() ? nullptr : it->second.get();
+        }
+
         // 获取默认日志器实例
         AsyncLogger::ptr DefaultLogger() { return default_logger_; }
 
@@ -52,18 +65,25 @@ namespace mylog {
         // 私有构造函数，保证只能通过GetInstance()创建实例
         LoggerManager()
         {
+            LoggerMap* loggers = new LoggerMap();
             // 在构造函数中创建并初始化一个默认日志器
             std::unique_ptr<LoggerBuilder> builder(new LoggerBuilder()); // 使用智能指针管理Builder生命周期
             builder->BuildLoggerName("default"); // 设置默认日志器名称
             default_logger_ = builder->Build(); // 构建默认日志器
             // 将默认日志器添加到管理器的哈希表中
-            loggers_.insert(std::make_pair("default", default_logger_));
+            loggers->insert(std::make_pair("default", default_logger_));
+            loggers_.store(loggers, std::memory_order_release);
         }
 
+        ~LoggerManager() { delete loggers_.load(std::memory_order_acquire); }
+
     private:
-        std::mutex mtx_; // 互斥锁，保护loggers_和default_logger_的并发访问
+        // 哈希表，键为日志器名称（std::string），值为日志器智能指针；创建后不再修改
+        using LoggerMap = std::unordered_map<std::string, AsyncLogger::ptr>;
+
+        std::mutex mtx_; // 互斥锁，保护写者对快照的替换
         AsyncLogger::ptr default_logger_; // 存储默认日志器
-        // 哈希表，键为日志器名称（std::string），值为日志器智能指针
-        std::unordered_map<std::string, AsyncLogger::ptr> loggers_;
+        std::atomic<const LoggerMap*> loggers_{nullptr}; // 当前快照，读者无锁访问
+        std::vector<std::unique_ptr<const LoggerMap>> retired_; // 被替换下来的旧快照
     };
 }
\ No newline at end of file
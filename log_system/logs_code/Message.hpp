@@ -2,10 +2,12 @@
 
 #include <memory> // 包含shared_ptr用于智能指针
 #include <thread> // 包含thread::get_id用于获取线程ID
-#include <sstream> // 包含stringstream用于日志格式化
+#include <sstream> // 包含stringstream用于线程ID转换
+#include <string>
 
 #include "Level.hpp" // 包含LogLevel定义
-#include "Util.hpp"  // 包含Util::Date::Now用于获取时间
+#include "Clock.hpp" // 包含Clock用于获取时间
+#include "Pattern.hpp" // 日志输出格式
 
 namespace mylog
 {
@@ -20,26 +22,41 @@ namespace mylog
             payload_(payload),
             level_(level),
             line_(line),
-            ctime_(Util::Date::Now()),
+            ctime_(Clock::NowNs()),
             tid_(std::this_thread::get_id()) {}
 		std::string format() 
         {   // 格式化日志消息
-	        std::stringstream ret; // 创建一个字符串流对象，用于格式化日志消息
-            // 获取当前时间
-            struct tm t;
-            localtime_r(&ctime_, &t); // 将时间戳转换为本地时间
-			char buf[128]; // 定义一个字符数组，用于存储格式化后的时间字符串
-			strftime(buf, sizeof(buf), "%H:%M:%S", &t); // 将本地时间格式化为字符串，格式为时:分:秒
-			std::string tmp1 = '[' + std::string(buf) + "]["; // 构建时间字符串的前半部分
-            std::string tmp2 = '[' + std::string(LogLevel::ToString(level_)) + "][" + name_ + "][" + file_name_ + ":" + std::to_string(line_) + "]\t" + payload_ + "\n";
-			ret << tmp1 << tid_ << tmp2; // 将时间字符串、线程ID、日志等级、日志器名、文件名、行号和信息体拼接成完整的日志消息
-            return ret.str();
+	        std::stringstream tid; // 线程ID只能通过流输出
+            tid << tid_;
+            std::string ret;
+            FormatTo(ret, level_, file_name_.c_str(), line_, name_, payload_.data(), payload_.size(), ctime_, tid.str());
+            return ret;
             // 日志消息实例：
-            // [12:34:56][12345][INFO][MyLogger][main.cpp:42]	日志内容
+            // [12:34:56.123456][12345][INFO][MyLogger][main.cpp:42]	日志内容
+        }
+
+        // FormatTo：不构造LogMessage，直接按默认格式把一条日志格式化追加到out中
+        // out可以是线程本地复用的字符串，容量足够时整个过程没有堆分配
+        static void FormatTo(std::string& out, LogLevel::value level, const char* file, size_t line,
+            const std::string& name, const char* payload, size_t len,
+            uint64_t ctime = Clock::NowNs(), const std::string& tid = ThreadIdString())
+        {
+            Pattern::Default()->FormatTo(out, LogFields{ctime, level, file, line, name, tid, {payload, len}});
+        }
+
+        // 当前线程ID的字符串形式，每个线程只转换一次
+        static const std::string& ThreadIdString()
+        {
+            thread_local std::string tid = [] {
+                std::stringstream ss;
+                ss << std::this_thread::get_id();
+                return ss.str();
+            }();
+            return tid;
         }
 
         size_t line_;           // 行号
-        time_t ctime_;          // 时间
+        uint64_t ctime_;        // 时间，墙上时钟纳秒
         std::string file_name_; // 文件名
         std::string name_;      // 日志器名
         std::string payload_;   // 信息体
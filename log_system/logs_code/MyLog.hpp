@@ -8,20 +8,124 @@ AsyncLogger::ptr GetLogger(const std::string &name) {
 // 用户获取默认日志器
 AsyncLogger::ptr DefaultLogger() { return LoggerManager::GetInstance().DefaultLogger(); }
 
+// 获取日志器并缓存在调用点：每个调用点只查找一次，之后直接使用裸指针，没有查表和引用计数开销
+// name必须是字符串字面量；日志器尚未添加时返回nullptr，且不缓存，下次继续查找
+// 例：MYLOG_LOGGER("asynclogger")->Info("upload %zu bytes", len);
+#define MYLOG_LOGGER(name)                                                                  \
+    ([]() -> ::mylog::AsyncLogger* {                                                        \
+        static std::atomic<::mylog::AsyncLogger*> mylog_cached_{nullptr};                  \
+        ::mylog::AsyncLogger* logger = mylog_cached_.load(std::memory_order_acquire);       \
+        if (logger == nullptr) {                                                            \
+            logger = ::mylog::LoggerManager::GetInstance().FindLogger(name);                \
+            mylog_cached_.store(logger, std::memory_order_release);                        \
+        }                                                                                   \
+        return logger;                                                                      \
+    }())
+
 // 简化用户使用，宏函数默认填上文件+行号
+// 低于MYLOG_MIN_LEVEL的等级展开为空函数Disabled()，参数不会求值
+#if MYLOG_MIN_LEVEL <= 0
 #define Debug(fmt, ...) Debug(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#else
+#define Debug(fmt, ...) Disabled()
+#endif
+#if MYLOG_MIN_LEVEL <= 1
 #define Info(fmt, ...) Info(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#else
+#define Info(fmt, ...) Disabled()
+#endif
+#if MYLOG_MIN_LEVEL <= 2
 #define Warn(fmt, ...) Warn(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#else
+#define Warn(fmt, ...) Disabled()
+#endif
+#if MYLOG_MIN_LEVEL <= 3
 #define Error(fmt, ...) Error(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#else
+#define Error(fmt, ...) Disabled()
+#endif
 #define Fatal(fmt, ...) Fatal(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 // 无需获取日志器，默认标准输出
-#define LOGDEBUGDEFAULT(fmt, ...) mylog::DefaultLogger()->Debug(fmt, ##__VA_ARGS__)
-#define LOGINFODEFAULT(fmt, ...) mylog::DefaultLogger()->Info(fmt, ##__VA_ARGS__)
-#define LOGWARNDEFAULT(fmt, ...) mylog::DefaultLogger()->Warn(fmt, ##__VA_ARGS__)
-#define LOGERRORDEFAULT(fmt, ...) mylog::DefaultLogger()->Error(fmt, ##__VA_ARGS__)
-#define LOGFATALDEFAULT(fmt, ...) mylog::DefaultLogger()->Fatal(fmt, ##__VA_ARGS__)
+// 先检查默认日志器的等级，等级不够时参数不会求值
+#define MYLOG_DEFAULT_LOG(level, method, fmt, ...)                               \
+    do {                                                                         \
+        auto mylog_logger_ = mylog::DefaultLogger();                             \
+        if (mylog_logger_->ShouldLog(level))                                     \
+            mylog_logger_->method(fmt, ##__VA_ARGS__);                           \
+    } while (0)
+#define LOGDEBUGDEFAULT(fmt, ...) MYLOG_DEFAULT_LOG(mylog::LogLevel::value::DEBUG, Debug, fmt, ##__VA_ARGS__)
+#define LOGINFODEFAULT(fmt, ...) MYLOG_DEFAULT_LOG(mylog::LogLevel::value::INFO, Info, fmt, ##__VA_ARGS__)
+#define LOGWARNDEFAULT(fmt, ...) MYLOG_DEFAULT_LOG(mylog::LogLevel::value::WARN, Warn, fmt, ##__VA_ARGS__)
+#define LOGERRORDEFAULT(fmt, ...) MYLOG_DEFAULT_LOG(mylog::LogLevel::value::ERROR, Error, fmt, ##__VA_ARGS__)
+#define LOGFATALDEFAULT(fmt, ...) MYLOG_DEFAULT_LOG(mylog::LogLevel::value::FATAL, Fatal, fmt, ##__VA_ARGS__)
+
+// 类型安全的格式化接口：格式串用{}占位，占位符个数在编译期检查，参数按实际类型格式化
+// 每个调用点只登记一次，延迟格式化的日志器只记录调用点id和参数
+// 先做编译期和运行时的等级检查，等级不够时参数不会求值；等级可以是运行时的值，随每条记录传递
+// 例：MYLOG_INFO(MYLOG_LOGGER("asynclogger"), "upload {} bytes to {}", len, path);
+// 结构化字段用mylog::KV附加，不占用{}，文本输出为" 键=值"，刷新器使用Pattern::kJson时输出为JSON成员：
+// 例：MYLOG_INFO(logger, "download done", mylog::KV("url", url), mylog::KV("bytes", len), mylog::KV("status", 200));
+#define MYLOG_LOG(logger, level, fmt, ...)                                       \
+    do {                                                                         \
+        MYLOG_CHECK_FORMAT(fmt, ##__VA_ARGS__);                                  \
+        if ((int)(level) < MYLOG_MIN_LEVEL)                                      \
+            break;                                                               \
+        const ::mylog::LogLevel::value mylog_level_ = (level);                   \
+        auto&& mylog_logger_ = (logger);                                         \
+        if (!mylog_logger_->ShouldLog(mylog_level_))                             \
+            break;                                                               \
+        static const ::mylog::CallSite& mylog_site_ =                            \
+            ::mylog::CallSiteRegistry::Register(__FILE__, __LINE__, mylog_level_, fmt); \
+        mylog_logger_->Log(mylog_level_, mylog_site_, ##__VA_ARGS__);            \
+    } while (0)
+#define MYLOG_DEBUG(logger, fmt, ...) MYLOG_LOG(logger, mylog::LogLevel::value::DEBUG, fmt, ##__VA_ARGS__)
+#define MYLOG_INFO(logger, fmt, ...) MYLOG_LOG(logger, mylog::LogLevel::value::INFO, fmt, ##__VA_ARGS__)
+#define MYLOG_WARN(logger, fmt, ...) MYLOG_LOG(logger, mylog::LogLevel::value::WARN, fmt, ##__VA_ARGS__)
+#define MYLOG_ERROR(logger, fmt, ...) MYLOG_LOG(logger, mylog::LogLevel::value::ERROR, fmt, ##__VA_ARGS__)
+#define MYLOG_FATAL(logger, fmt, ...) MYLOG_LOG(logger, mylog::LogLevel::value::FATAL, fmt, ##__VA_ARGS__)
+
+// 限流和采样：每个调用点有自己的SiteLimiter，在格式化之前检查，被拦下的日志参数不会求值
+// 被拦下的条数由日志器定期输出一条"N messages suppressed by rate limit at 文件:行号"
+// 例：MYLOG_WARN_RATE(MYLOG_LOGGER("asynclogger"), 10, "read {} failed", path);  每秒最多10条
+//     MYLOG_INFO_EVERY_N(MYLOG_LOGGER("asynclogger"), 100, "get req {}", url);     每100条输出1条
+#define MYLOG_LOG_LIMITED(logger, level, policy, fmt, ...)                       \
+    do {                                                                         \
+        MYLOG_CHECK_FORMAT(fmt, ##__VA_ARGS__);                                  \
+        if ((int)(level) < MYLOG_MIN_LEVEL)                                      \
+            break;                                                               \
+        const ::mylog::LogLevel::value mylog_level_ = (level);                   \
+        auto&& mylog_logger_ = (logger);                                         \
+        if (!mylog_logger_->ShouldLog(mylog_level_))                             \
+            break;                                                               \
+        static ::mylog::SiteLimiter mylog_limiter_(policy, __FILE__, __LINE__);  \
+        if (!mylog_limiter_.Allow(&*mylog_logger_))                              \
+            break;                                                               \
+        static const ::mylog::CallSite& mylog_site_ =                            \
+            ::mylog::CallSiteRegistry::Register(__FILE__, __LINE__, mylog_level_, fmt); \
+        mylog_logger_->Log(mylog_level_, mylog_site_, ##__VA_ARGS__);            \
+    } while (0)
+#define MYLOG_DEBUG_RATE(logger, per_second, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::DEBUG, ::mylog::LimitPolicy::Rate(per_second), fmt, ##__VA_ARGS__)
+#define MYLOG_INFO_RATE(logger, per_second, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::INFO, ::mylog::LimitPolicy::Rate(per_second), fmt, ##__VA_ARGS__)
+#define MYLOG_WARN_RATE(logger, per_second, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::WARN, ::mylog::LimitPolicy::Rate(per_second), fmt, ##__VA_ARGS__)
+#define MYLOG_ERROR_RATE(logger, per_second, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::ERROR, ::mylog::LimitPolicy::Rate(per_second), fmt, ##__VA_ARGS__)
+#define MYLOG_DEBUG_EVERY_N(logger, n, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::DEBUG, ::mylog::LimitPolicy::Sample(n), fmt, ##__VA_ARGS__)
+#define MYLOG_INFO_EVERY_N(logger, n, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::INFO, ::mylog::LimitPolicy::Sample(n), fmt, ##__VA_ARGS__)
+#define MYLOG_WARN_EVERY_N(logger, n, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::WARN, ::mylog::LimitPolicy::Sample(n), fmt, ##__VA_ARGS__)
+#define MYLOG_ERROR_EVERY_N(logger, n, fmt, ...) MYLOG_LOG_LIMITED(logger, mylog::LogLevel::value::ERROR, ::mylog::LimitPolicy::Sample(n), fmt, ##__VA_ARGS__)
+
+// printf风格接口的限流：调用点是否放行这一条，放在日志语句之前判断
+// 与MYLOG_LOG_LIMITED相同，先检查等级，等级不够时不消耗令牌，也不计入被拦下的条数
+// 例：if (MYLOG_ALLOW(logger, mylog::LogLevel::value::ERROR, ::mylog::LimitPolicy::Rate(10))) logger->Error("open %s failed", path);
+#define MYLOG_ALLOW(logger, level, policy)                                       \
+    ([&](auto&& mylog_logger_) -> bool {                                         \
+        if ((int)(level) < MYLOG_MIN_LEVEL || !mylog_logger_->ShouldLog(level))  \
+            return false;                                                        \
+        static ::mylog::SiteLimiter mylog_limiter_(policy, __FILE__, __LINE__);  \
+        return mylog_limiter_.Allow(&*mylog_logger_);                            \
+    }(logger))
 }  // namespace mylog
 
 //	第一组：适合有多个日志器、需要指定日志器时用。
-//	第二组：适合简单场景，直接用默认日志器，写日志更方便。
\ No newline at end of file
+//	第二组：适合简单场景，直接用默认日志器，写日志更方便。
+//	第三组：类型安全的{}格式化，格式串在编译期检查，推荐新代码使用。
\ No newline at end of file
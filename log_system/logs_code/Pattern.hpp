@@ -0,0 +1,203 @@
+/*日志输出格式设计*/
+#pragma once
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Level.hpp" // 日志级别定义
+#include "Clock.hpp" // 时间格式化
+#include "Format.hpp" // JSON转义
+
+namespace mylog {
+    // 一条日志中可以输出的字段
+    struct LogFields {
+        uint64_t ctime;           // 时间，墙上时钟纳秒
+        LogLevel::value level;    // 等级
+        std::string_view file;    // 文件名
+        size_t line;              // 行号
+        std::string_view name;    // 日志器名
+        std::string_view tid;     // 线程ID
+        std::string_view payload; // 信息体
+        std::string_view fields{}; // 结构化字段，已转义的JSON对象成员（以逗号开头），只由%J输出
+    };
+
+    // Pattern：日志输出格式，构造时把格式串解析为一组操作，格式化时按顺序执行，不再解析格式串
+    // 支持的占位符：
+    //   %T 时:分:秒[.小数]  %t 线程ID  %l 等级  %n 日志器名
+    //   %s 文件名  %# 行号  %v 信息体  %% 百分号
+    //   %J 整条日志输出为一个JSON对象，结构化字段作为对象的成员，kJson即每行一个JSON对象
+    // 其他字符原样输出，每条日志末尾自动追加换行
+    class Pattern {
+    public:
+        using ptr = std::shared_ptr<const Pattern>;
+
+        // 与原有固定格式一致：[12:34:56.123456][12345][INFO][MyLogger][main.cpp:42]	日志内容
+        static constexpr const char* kDefault = "[%T][%t][%l][%n][%s:%#]\t%v";
+        // JSON lines：{"ts":纳秒,"time":"12:34:56.123456","level":"INFO","logger":"MyLogger","tid":"12345",
+        //              "file":"main.cpp","line":42,"msg":"日志内容","bytes":1024}
+        static constexpr const char* kJson = "%J";
+
+        explicit Pattern(const std::string& pattern = kDefault) : pattern_(pattern)
+        {
+            for (size_t i = 0; i < pattern.size(); ++i) {
+                char c = pattern[i];
+                if (c == '%' && i + 1 < pattern.size()) {
+                    Field f = ToField(pattern[i + 1]);
+                    if (f != Field::LITERAL) {
+                        ops_.push_back(Op{f, 0, 0});
+                        ++counts_[(int)f];
+                        ++i;
+                        continue;
+                    }
+                    if (pattern[i + 1] == '%')
+                        ++i; // %%输出一个%
+                }
+                // 相邻的普通字符合并为一段
+                if (ops_.empty() || ops_.back().field != Field::LITERAL)
+                    ops_.push_back(Op{Field::LITERAL, literals_.size(), 0});
+                literals_.push_back(pattern[i]);
+                ++ops_.back().len;
+            }
+        }
+
+        // 所有未指定格式的日志器和刷新器共用的默认格式
+        static const ptr& Default()
+        {
+            static ptr pattern = std::make_shared<Pattern>();
+            return pattern;
+        }
+
+        const std::string& Str() const { return pattern_; }
+
+        // 是否输出JSON：结构化字段交给%J作为JSON成员输出，否则以文本形式追加在信息体之后
+        bool IsJson() const { return counts_[(int)Field::JSON] > 0; }
+
+        // MaxSize：FormatTo最多写入的字节数，用于在缓冲区中预留空间
+        size_t MaxSize(std::string_view file, std::string_view name, std::string_view tid, size_t len,
+            size_t fields_len = 0) const
+        {
+            // 等级最长5个字符，行号最长20位，末尾一个换行；JSON中的字符串转义后最多6倍长
+            size_t json = kJsonOverhead + Clock::kMaxTimeSize + 6 * (name.size() + tid.size() + file.size() + len) + fields_len;
+            return literals_.size() + 1 +
+                counts_[(int)Field::JSON] * json +
+                counts_[(int)Field::TIME] * Clock::kMaxTimeSize +
+                counts_[(int)Field::TID] * tid.size() +
+                counts_[(int)Field::LEVEL] * 5 +
+                counts_[(int)Field::NAME] * name.size() +
+                counts_[(int)Field::FILE] * file.size() +
+                counts_[(int)Field::LINE] * 20 +
+                counts_[(int)Field::PAYLOAD] * len;
+        }
+
+        // FormatTo：把一条日志直接格式化到out指向的内存中，out至少要有MaxSize字节，返回实际写入的字节数
+        size_t FormatTo(char* out, const LogFields& r) const
+        {
+            char* p = out;
+            auto put = [&p](const char* s, size_t n) { memcpy(p, s, n); p += n; };
+            for (const Op& op : ops_) {
+                switch (op.field) {
+                    case Field::LITERAL: put(literals_.data() + op.offset, op.len); break;
+                    case Field::TIME: p += Clock::FormatTime(p, r.ctime); break;
+                    case Field::TID: put(r.tid.data(), r.tid.size()); break;
+                    case Field::LEVEL: { const char* lv = LogLevel::ToString(r.level); put(lv, strlen(lv)); break; }
+                    case Field::NAME: put(r.name.data(), r.name.size()); break;
+                    case Field::FILE: put(r.file.data(), r.file.size()); break;
+                    case Field::LINE: p += WriteNumber(p, r.line); break;
+                    case Field::PAYLOAD: put(r.payload.data(), r.payload.size()); break;
+                    case Field::JSON: p += FormatJson(p, r); break;
+                    default: break;
+                }
+            }
+            *p++ = '\n';
+            return p - out;
+        }
+
+        // FormatTo：把一条日志格式化追加到out中，out是复用的字符串时容量足够就没有堆分配
+        void FormatTo(std::string& out, const LogFields& r) const
+        {
+            size_t old = out.size();
+            out.resize(old + MaxSize(r.file, r.name, r.tid, r.payload.size(), r.fields.size()));
+            size_t n = FormatTo(&out[old], r);
+            out.resize(old + n);
+        }
+
+    private:
+        enum class Field : int { LITERAL, TIME, TID, LEVEL, NAME, FILE, LINE, PAYLOAD, JSON, COUNT };
+
+        // JSON对象中固定部分的长度上限：键名、引号和分隔符，以及时间戳、等级、行号
+        static constexpr size_t kJsonOverhead = 160;
+
+        // 一个格式化操作，普通字符段记录在literals_中的位置
+        struct Op {
+            Field field;
+            size_t offset;
+            size_t len;
+        };
+
+        static Field ToField(char c)
+        {
+            switch (c) {
+                case 'T': return Field::TIME;
+                case 't': return Field::TID;
+                case 'l': return Field::LEVEL;
+                case 'n': return Field::NAME;
+                case 's': return Field::FILE;
+                case '#': return Field::LINE;
+                case 'v': return Field::PAYLOAD;
+                case 'J': return Field::JSON;
+                default: return Field::LITERAL;
+            }
+        }
+
+        // FormatJson：把一条日志写为一个JSON对象，字符串字段逐个转义，结构化字段已经转义过，原样拼接
+        static size_t FormatJson(char* out, const LogFields& r)
+        {
+            char* p = out;
+            auto put = [&p](const char* s, size_t n) { memcpy(p, s, n); p += n; };
+            auto str = [&p, &put](const char* key, size_t key_len, std::string_view v) {
+                put(key, key_len);
+                *p++ = '"';
+                p += fmt::EscapeJson(p, v);
+                *p++ = '"';
+            };
+            const char* lv = LogLevel::ToString(r.level);
+            put("{\"ts\":", 6);
+            p += WriteNumber(p, r.ctime);
+            put(",\"time\":\"", 9);
+            p += Clock::FormatTime(p, r.ctime);
+            put("\",\"level\":\"", 11);
+            put(lv, strlen(lv));
+            *p++ = '"';
+            str(",\"logger\":", 10, r.name);
+            str(",\"tid\":", 7, r.tid);
+            str(",\"file\":", 8, r.file);
+            put(",\"line\":", 8);
+            p += WriteNumber(p, r.line);
+            str(",\"msg\":", 7, r.payload);
+            put(r.fields.data(), r.fields.size());
+            *p++ = '}';
+            return p - out;
+        }
+
+        // 十进制输出无符号数，返回写入的字节数
+        static size_t WriteNumber(char* out, size_t v)
+        {
+            char tmp[20];
+            size_t n = 0;
+            do {
+                tmp[n++] = '0' + v % 10;
+                v /= 10;
+            } while (v);
+            for (size_t i = 0; i < n; ++i)
+                out[i] = tmp[n - 1 - i];
+            return n;
+        }
+
+    private:
+        std::string pattern_;                  // 原始格式串
+        std::vector<Op> ops_;                  // 解析后的操作序列
+        std::string literals_;                 // 所有普通字符段
+        size_t counts_[(int)Field::COUNT] = {}; // 每种字段出现的次数，用于计算MaxSize
+    };
+} // namespace mylog
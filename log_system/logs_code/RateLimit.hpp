@@ -0,0 +1,153 @@
+/*调用点限流与采样设计*/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mylog {
+    // 调用点的限流策略：每秒最多rate条（令牌桶，允许burst条突发），或每n条只输出1条
+    struct LimitPolicy {
+        uint64_t rate = 0;   // 每秒最多输出的条数，0表示不限速
+        uint64_t burst = 1;  // 令牌桶容量，可以连续输出的条数
+        uint64_t every = 0;  // 每every条输出1条，0或1表示不采样
+
+        static LimitPolicy Rate(uint64_t per_second, uint64_t burst = 1)
+        {
+            LimitPolicy p;
+            p.rate = per_second;
+            p.burst = burst ? burst : 1;
+            return p;
+        }
+        static LimitPolicy Sample(uint64_t n)
+        {
+            LimitPolicy p;
+            p.every = n;
+            return p;
+        }
+    };
+
+    // SiteLimiter：一个日志调用点的限流状态，由MyLog.hpp中的宏作为静态局部变量创建
+    // Allow只有一两次原子操作，在格式化之前调用；被拦下的条数按日志器分别累加，
+    // 由各日志器的消费者线程定期取走自己的条数并输出一条提示，不会悄无声息地丢失
+    // 同一个调用点可能轮流使用多个日志器（例如日志器作为函数参数传入），每个日志器占一个槽位，
+    // 超过kOwnerSlots个日志器时多出的条数记在spilled_中，由最先报告的日志器注明后输出
+    class SiteLimiter {
+    public:
+        static constexpr size_t kOwnerSlots = 4; // 分别计数的日志器个数
+
+        SiteLimiter(const LimitPolicy& policy, const char* file, size_t line)
+            : policy_(policy), file_(file), line_(line),
+            interval_ns_(policy.rate ? 1000000000ull / policy.rate : 0),
+            tolerance_ns_(policy.rate ? (policy.burst - 1) * (1000000000ull / policy.rate) : 0)
+        {
+            // 挂到全局链表头部，只增不删，遍历时无锁
+            next_ = Head().load(std::memory_order_relaxed);
+            while (!Head().compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed))
+                ;
+        }
+
+        // Allow：是否输出这一条，owner是调用时使用的日志器，用于把被拦下的条数报告给它
+        bool Allow(const void* owner)
+        {
+            bool allow = true;
+            if (policy_.every > 1)
+                allow = count_.fetch_add(1, std::memory_order_relaxed) % policy_.every == 0;
+            if (allow && interval_ns_ > 0)
+                allow = TakeToken();
+            if (!allow) {
+                if (OwnerSlot* slot = Claim(owner))
+                    slot->suppressed.fetch_add(1, std::memory_order_relaxed);
+                else
+                    spilled_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return allow;
+        }
+
+        // TakeSuppressed：取走owner的日志在这个调用点被拦下的条数
+        size_t TakeSuppressed(const void* owner)
+        {
+            for (OwnerSlot& slot : slots_)
+                if (slot.owner.load(std::memory_order_acquire) == owner)
+                    return slot.suppressed.load(std::memory_order_relaxed) ? slot.suppressed.exchange(0, std::memory_order_relaxed) : 0;
+            return 0;
+        }
+
+        // TakeSpilled：取走槽位用完后无法区分日志器的被拦下条数
+        size_t TakeSpilled()
+        {
+            return spilled_.load(std::memory_order_relaxed) ? spilled_.exchange(0, std::memory_order_relaxed) : 0;
+        }
+
+        // Release：日志器析构时调用，取走剩余的条数并让出槽位，之后地址相同的新日志器不会继承这些条数
+        size_t Release(const void* owner)
+        {
+            for (OwnerSlot& slot : slots_)
+                if (slot.owner.load(std::memory_order_acquire) == owner) {
+                    size_t n = slot.suppressed.exchange(0, std::memory_order_relaxed);
+                    slot.owner.store(nullptr, std::memory_order_release);
+                    return n;
+                }
+            return 0;
+        }
+
+        const char* File() const { return file_; }
+        size_t Line() const { return line_; }
+        SiteLimiter* Next() const { return next_; }
+
+        // 所有调用点的链表头
+        static SiteLimiter* First() { return Head().load(std::memory_order_acquire); }
+
+    private:
+        // 一个日志器在这个调用点被拦下的条数
+        struct OwnerSlot {
+            std::atomic<const void*> owner{nullptr};
+            std::atomic<size_t> suppressed{0};
+        };
+
+        // Claim：找到owner的槽位，没有时占用一个空槽位，槽位用完时返回nullptr
+        OwnerSlot* Claim(const void* owner)
+        {
+            for (OwnerSlot& slot : slots_) {
+                const void* cur = slot.owner.load(std::memory_order_acquire);
+                if (cur == nullptr && slot.owner.compare_exchange_strong(cur, owner, std::memory_order_acq_rel))
+                    return &slot;
+                if (cur == owner)
+                    return &slot;
+            }
+            return nullptr;
+        }
+
+        // 令牌桶按GCRA实现：tat_是理论上下一条可以输出的时间，早于它tolerance_ns_以内的仍然放行
+        bool TakeToken()
+        {
+            uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            uint64_t tat = tat_.load(std::memory_order_relaxed);
+            while (true) {
+                uint64_t base = tat > now ? tat : now;
+                if (base - now > tolerance_ns_)
+                    return false;
+                if (tat_.compare_exchange_weak(tat, base + interval_ns_, std::memory_order_relaxed))
+                    return true;
+            }
+        }
+
+        static std::atomic<SiteLimiter*>& Head()
+        {
+            static std::atomic<SiteLimiter*> head{nullptr};
+            return head;
+        }
+
+    private:
+        LimitPolicy policy_;                   // 限流策略
+        const char* file_;                     // 调用点文件名（字符串字面量）
+        size_t line_;                          // 调用点行号
+        uint64_t interval_ns_;                 // 令牌间隔
+        uint64_t tolerance_ns_;                // 允许突发的时间
+        std::atomic<uint64_t> count_{0};       // 采样计数
+        std::atomic<uint64_t> tat_{0};         // 令牌桶的理论到达时间
+        OwnerSlot slots_[kOwnerSlots];         // 各日志器尚未报告的被拦下条数
+        std::atomic<size_t> spilled_{0};       // 槽位用完后尚未报告的被拦下条数
+        SiteLimiter* next_ = nullptr;          // 链表中的下一个调用点
+    };
+} // namespace mylog
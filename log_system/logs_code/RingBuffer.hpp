@@ -0,0 +1,129 @@
+/*无锁多生产者单消费者(MPSC)环形缓冲区设计*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include "AsyncBuffer.hpp"
+
+namespace mylog {
+    // RingBuffer：有界的MPSC环形缓冲区，生产者通过CAS抢占连续的槽位，无需加锁
+    // 每个槽位独占一个缓存行，避免不同生产者写相邻槽位时发生伪共享
+    // 一条日志可能跨越多个连续槽位，长度记录在首个槽位中
+    class RingBuffer {
+    public:
+        static constexpr size_t kCacheLine = 64; // 缓存行大小
+
+    private:
+        struct alignas(kCacheLine) Slot {
+            std::atomic<size_t> seq; // 槽位序号：等于位置pos表示空闲，等于pos+1表示数据已发布
+            uint32_t len;            // 整条日志的长度，只有首个槽位有效
+            uint8_t levels;          // 这段数据中日志等级的掩码，只有首个槽位有效
+            char data[kCacheLine - sizeof(std::atomic<size_t>) - sizeof(uint32_t) - sizeof(uint8_t)];
+        };
+
+    public:
+        static constexpr size_t kSlotPayload = sizeof(Slot::data); // 每个槽位可容纳的数据字节数
+
+        // 构造函数：槽位数量向上取整为2的幂，便于用掩码计算下标
+        explicit RingBuffer(size_t slot_count)
+            : enqueue_pos_(0), dequeue_pos_(0)
+        {
+            capacity_ = 1024;
+            while (capacity_ < slot_count)
+                capacity_ <<= 1;
+            mask_ = capacity_ - 1;
+            slots_.reset(new Slot[capacity_]);
+            for (size_t i = 0; i < capacity_; ++i)
+                slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        // 单条日志允许的最大长度，超过则无法放入环形缓冲区
+        size_t MaxRecordSize() const { return capacity_ * kSlotPayload; }
+
+        // TryPush：生产者调用，空间不足时返回false，不阻塞；levels是这段数据中日志等级的掩码
+        bool TryPush(const char* data, size_t len, uint32_t levels)
+        {
+            size_t need = SlotsFor(len);
+            if (need > capacity_)
+                return false;
+            size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                // 消费者按顺序释放槽位，所以只要本次占用的最后一个槽位空闲，前面的槽位也一定空闲
+                Slot& last = slots_[(pos + need - 1) & mask_];
+                size_t seq = last.seq.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)(pos + need - 1);
+                if (diff == 0)
+                {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + need, std::memory_order_relaxed))
+                        break; // 抢占成功
+                }
+                else if (diff < 0)
+                    return false; // 环形缓冲区已满
+                else
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+
+            // 将数据拷贝到抢占到的槽位中
+            size_t copied = 0;
+            for (size_t i = 0; i < need; ++i)
+            {
+                size_t n = std::min(kSlotPayload, len - copied);
+                memcpy(slots_[(pos + i) & mask_].data, data + copied, n);
+                copied += n;
+            }
+            Slot& first = slots_[pos & mask_];
+            first.len = (uint32_t)len;
+            first.levels = (uint8_t)levels;
+            first.seq.store(pos + 1, std::memory_order_release); // 发布：消费者看到后即可读取整条日志
+            return true;
+        }
+
+        // PopTo：消费者调用，批量取出所有已发布的日志追加到buf中并标记它们的等级，返回取出的字节数
+        size_t PopTo(Buffer& buf)
+        {
+            size_t total = 0;
+            while (true)
+            {
+                Slot& first = slots_[dequeue_pos_ & mask_];
+                if (first.seq.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+                    break; // 没有已发布的数据（或生产者尚未写完）
+                size_t len = first.len;
+                size_t need = SlotsFor(len);
+                size_t copied = 0;
+                buf.Reserve(len); // 一条日志的各个片段写入同一个分段
+                buf.AddLevels(first.levels);
+                for (size_t i = 0; i < need; ++i)
+                {
+                    size_t n = std::min(kSlotPayload, len - copied);
+                    buf.Push(slots_[(dequeue_pos_ + i) & mask_].data, n);
+                    copied += n;
+                }
+                // 按顺序释放槽位，供下一轮生产者使用
+                for (size_t i = 0; i < need; ++i)
+                    slots_[(dequeue_pos_ + i) & mask_].seq.store(dequeue_pos_ + i + capacity_, std::memory_order_release);
+                dequeue_pos_ += need;
+                total += len;
+            }
+            return total;
+        }
+
+        // 判断是否有待消费的数据（仅消费者线程调用）
+        bool IsEmpty()
+        {
+            return slots_[dequeue_pos_ & mask_].seq.load(std::memory_order_acquire) != dequeue_pos_ + 1;
+        }
+
+    private:
+        static size_t SlotsFor(size_t len) { return len == 0 ? 1 : (len + kSlotPayload - 1) / kSlotPayload; }
+
+    private:
+        std::unique_ptr<Slot[]> slots_; // 槽位数组
+        size_t capacity_;               // 槽位数量（2的幂）
+        size_t mask_;                   // 下标掩码
+        alignas(kCacheLine) std::atomic<size_t> enqueue_pos_; // 生产者抢占位置，独占缓存行
+        alignas(kCacheLine) size_t dequeue_pos_;              // 消费者读取位置，只有消费者线程访问
+    };
+} // namespace mylog
@@ -0,0 +1,185 @@
+/*刷新器独立队列设计*/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AsyncBuffer.hpp" // 消费者交出的分段缓冲区
+#include "LogFlush.hpp" // 被包装的刷新器
+#include "Message.hpp" // 丢弃提示的日志格式
+#include "SyncPolicy.hpp" // 空闲时按持久化策略同步
+
+extern mylog::Util::JsonData* g_conf_data;
+
+namespace mylog {
+    // 刷新器队列策略：启用后每个刷新器有自己的有界队列和写入线程，慢的刷新器只影响自己的队列
+    struct SinkQueuePolicy {
+        bool enable = false;  // 是否启用
+        size_t max_bytes = 0; // 每个队列中待写入数据的上限，0表示使用配置文件中的sink_queue_max
+        bool block = true;    // 队列满时：true等待（反压到消费者线程），false丢弃这批数据
+    };
+
+    // SinkQueue：一个刷新器的写入队列和写入线程
+    // 队列中保存的是整批数据的引用计数指针，同一批数据由所有刷新器共享，不为每个刷新器拷贝
+    // 最后一个写完的刷新器释放引用时，分段还回分段池
+    class SinkQueue {
+    public:
+        using ptr = std::shared_ptr<SinkQueue>;
+
+        // pattern是日志器的输出格式，刷新器没有自己的格式时丢弃提示按它输出，与日志记录一致
+        SinkQueue(LogFlush::ptr flush, const SinkQueuePolicy& policy, const std::string& logger_name, Pattern::ptr pattern)
+            : flush_(std::move(flush)),
+            max_bytes_(policy.max_bytes ? policy.max_bytes : g_conf_data->sink_queue_max),
+            block_(policy.block),
+            logger_name_(logger_name),
+            pattern_(flush_->GetPattern() ? flush_->GetPattern() : pattern ? pattern : Pattern::Default())
+        {
+            thread_ = std::thread(&SinkQueue::ThreadEntry, this);
+        }
+
+        // 析构时先写完队列中剩余的数据再退出
+        ~SinkQueue()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                stop_ = true;
+            }
+            cond_consumer_.notify_all();
+            thread_.join();
+        }
+
+        const LogFlush::ptr& Flush() const { return flush_; }
+
+        // Push方法：消费者线程调用，chunks和text二选一，force为true时写入后立即同步
+        void Push(std::shared_ptr<const Buffer> chunks, std::shared_ptr<const std::string> text, bool force)
+        {
+            size_t bytes = chunks ? chunks->ReadableSize() : text ? text->size() : 0;
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (bytes > 0 && pending_bytes_ > 0 && pending_bytes_ + bytes > max_bytes_) {
+                if (!block_) {
+                    dropped_batches_.fetch_add(1, std::memory_order_relaxed);
+                    dropped_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+                    if (!force)
+                        return;
+                    chunks.reset(); // 丢弃数据，仍然保留同步请求
+                    text.reset();
+                    bytes = 0;
+                } else {
+                    // 队列为空时总能放入一批，超长的一批不会永远等待
+                    cond_producer_.wait(lock, [&]() { return pending_bytes_ == 0 || pending_bytes_ + bytes <= max_bytes_; });
+                }
+            }
+            pending_bytes_ += bytes;
+            items_.push_back(Item{std::move(chunks), std::move(text), bytes, force});
+            lock.unlock();
+            cond_consumer_.notify_one();
+        }
+
+        // 因队列已满被丢弃的批次数和字节数
+        size_t DroppedBatches() const { return dropped_batches_.load(std::memory_order_relaxed); }
+        size_t DroppedBytes() const { return dropped_bytes_.load(std::memory_order_relaxed); }
+        // 队列中待写入的字节数
+        size_t PendingBytes()
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            return pending_bytes_;
+        }
+
+    private:
+        struct Item {
+            std::shared_ptr<const Buffer> chunks;   // 消费者交出的整批分段
+            std::shared_ptr<const std::string> text; // 合并或还原后的文本
+            size_t bytes;                            // 数据量
+            bool force;                              // 写入后是否立即同步
+        };
+
+        void ThreadEntry()
+        {
+            // 按时间分组同步磁盘时，空闲时也要定时检查，避免最后一批数据迟迟不落盘
+            SyncPolicy policy = flush_->GetSyncPolicy(); // 刷新器自己的持久化策略
+            std::chrono::milliseconds idle = policy.Grouped() && policy.interval.count() > 0
+                ? policy.interval : std::chrono::milliseconds(0);
+            std::vector<struct iovec> iov;
+            while (true) {
+                Item item;
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    auto ready = [&]() { return stop_ || !items_.empty(); };
+                    if (idle.count() > 0) {
+                        if (!cond_consumer_.wait_for(lock, idle, ready)) {
+                            lock.unlock();
+                            flush_->Sync(false);
+                            continue;
+                        }
+                    } else {
+                        cond_consumer_.wait(lock, ready);
+                    }
+                    if (items_.empty()) { // stop_且队列已空
+                        lock.unlock();
+                        ReportDrops(); // 最后几批被丢弃时也要留下提示
+                        flush_->Sync(false);
+                        break;
+                    }
+                    item = std::move(items_.front());
+                    items_.pop_front();
+                }
+                ReportDrops();
+                if (item.chunks) {
+                    item.chunks->ToIovec(iov);
+                    if (!iov.empty())
+                        flush_->FlushV(iov.data(), (int)iov.size());
+                } else if (item.text && !item.text->empty()) {
+                    flush_->Flush(item.text->data(), item.text->size());
+                }
+                flush_->Sync(item.force);
+                size_t bytes = item.bytes;
+                item = Item(); // 先释放这批数据的引用，分段尽早还回分段池
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    pending_bytes_ -= bytes;
+                }
+                cond_producer_.notify_all();
+            }
+        }
+
+        // ReportDrops方法：上一次提示之后有数据被丢弃时，在本刷新器中输出一条提示
+        // 需要原始记录的刷新器不能写入文本，只计数
+        void ReportDrops()
+        {
+            size_t batches = DroppedBatches();
+            if (batches == reported_batches_ || flush_->NeedRaw())
+                return;
+            size_t bytes = DroppedBytes();
+            std::string payload = std::to_string(batches - reported_batches_) + " batches (" +
+                std::to_string(bytes - reported_bytes_) + " bytes) dropped by slow sink";
+            reported_batches_ = batches;
+            reported_bytes_ = bytes;
+            std::string text;
+            pattern_->FormatTo(text, LogFields{Clock::NowNs(), LogLevel::value::WARN, __FILE__, __LINE__,
+                logger_name_, LogMessage::ThreadIdString(), payload});
+            flush_->Flush(text.data(), text.size());
+        }
+
+    private:
+        LogFlush::ptr flush_; // 被包装的刷新器，只在写入线程中调用
+        size_t max_bytes_; // 队列中待写入数据的上限
+        bool block_; // 队列满时是否等待
+        std::string logger_name_; // 日志器名称，用于丢弃提示
+        Pattern::ptr pattern_; // 丢弃提示的输出格式
+        std::mutex mtx_; // 保护队列
+        std::condition_variable cond_producer_; // 队列有空间时通知消费者线程
+        std::condition_variable cond_consumer_; // 队列有数据时通知写入线程
+        std::deque<Item> items_; // 待写入的批次
+        size_t pending_bytes_ = 0; // 队列中待写入的字节数
+        bool stop_ = false; // 停止标志
+        std::atomic<size_t> dropped_batches_{0}; // 丢弃的批次数
+        std::atomic<size_t> dropped_bytes_{0}; // 丢弃的字节数
+        size_t reported_batches_ = 0; // 已输出过提示的丢弃批次数，只有写入线程访问
+        size_t reported_bytes_ = 0; // 已输出过提示的丢弃字节数，只有写入线程访问
+        std::thread thread_; // 写入线程，其他成员都初始化后在构造函数中启动
+    };
+} // namespace mylog
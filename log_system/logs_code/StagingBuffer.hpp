@@ -0,0 +1,273 @@
+/*生产者线程本地暂存缓冲区设计*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AsyncWorker.hpp"
+
+namespace mylog {
+    // 暂存策略：每个生产者线程先把日志写进自己的暂存区，攒够batch_bytes字节再一次性交给AsyncWorker，
+    // 线程空闲时由消费者线程把超过max_delay未交出的暂存数据收走，线程退出时自动交出
+    // merge_by_time为true时每条日志带上时间戳，消费者按时间戳合并各线程（和各分片）的日志后再落地：
+    // 只要还有线程的暂存区里有更早的日志，较新的日志就留在消费者中等待，其他线程都没有暂存数据时立即输出，
+    // 最多多等max_delay；输出严格按时间戳排序，没有迟到后乱序输出的日志
+    // 不启用时只保证同一线程内的顺序，不同线程的日志按交出的批次交错
+    struct StagingPolicy {
+        bool enable = false;                      // 是否启用线程暂存
+        size_t batch_bytes = 64 * 1024;           // 暂存区达到该字节数即交给AsyncWorker
+        std::chrono::milliseconds max_delay{5};   // 暂存数据最长滞留时间
+        bool merge_by_time = false;               // 是否按时间戳合并各线程日志
+    };
+
+    // 带时间戳模式下每条日志前的记录头
+    struct StagedRecordHeader {
+        uint64_t ts;    // 日志产生时间(steady_clock纳秒)，各线程之间可比较
+        uint32_t len;   // 日志内容长度
+        uint32_t level; // 日志等级，合并后随输出的日志交给刷新器
+    };
+
+    // 单调时钟纳秒数
+    inline uint64_t SteadyNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // StagingBuffer：某个线程在某个日志器上的暂存区
+    // 只有所属线程会写入，消费者线程偶尔来收取，所以用一个几乎无竞争的自旋锁保护
+    class StagingBuffer {
+    public:
+        using ptr = std::shared_ptr<StagingBuffer>;
+
+        StagingBuffer(std::weak_ptr<AsyncWorker> worker, const StagingPolicy& policy)
+            : worker_(worker), policy_(policy) {
+            data_.reserve(policy_.batch_bytes * 2);
+        }
+
+        // Append：所属线程调用，写入一条日志，达到阈值后交给AsyncWorker
+        // 每条日志的位置和等级随批次一起交出，过载时AsyncWorker逐条按等级丢弃
+        void Append(const char* data, size_t len, LogLevel::value level = LogLevel::value::FATAL) {
+            Lock();
+            if (data_.empty()) {
+                // 先发布0再取时间，消费者读到之前的UINT64_MAX时，这条日志的时间戳一定不早于消费者的水位线
+                pending_since_.store(0);
+                first_ns_ = SteadyNowNs();
+                pending_since_.store(first_ns_);
+            }
+            size_t offset = data_.size();
+            if (policy_.merge_by_time) {
+                StagedRecordHeader head{SteadyNowNs(), (uint32_t)len, (uint32_t)level};
+                data_.append((const char*)&head, sizeof(head));
+            }
+            data_.append(data, len);
+            records_.push_back(BatchRecord{(uint32_t)offset, (uint32_t)(data_.size() - offset), level});
+            levels_ |= LogLevel::Bit(level);
+            if (data_.size() >= policy_.batch_bytes)
+                FlushLocked();
+            Unlock();
+        }
+
+        // Flush：把暂存的数据全部交给AsyncWorker（线程主动调用、线程退出或日志器析构时）
+        void Flush() {
+            Lock();
+            FlushLocked();
+            Unlock();
+        }
+
+        // Collect：消费者线程在AsyncWorker的收取函数中调用，把滞留过久的数据交给消费者
+        // 持有暂存区锁期间写入，保证与所属线程前后交出的批次顺序一致；所属线程正在写入时拿不到锁就跳过，下一轮再收
+        void Collect(AsyncWorker& worker, uint64_t now_ns, bool force) {
+            if (lock_.test_and_set(std::memory_order_acquire))
+                return;
+            uint64_t max_delay = std::chrono::duration_cast<std::chrono::nanoseconds>(policy_.max_delay).count();
+            if (!data_.empty() && (force || now_ns - first_ns_ >= max_delay)) {
+                worker.PushCollected(data_.data(), data_.size(), levels_);
+                data_.clear();
+                records_.clear();
+                levels_ = 0;
+                pending_since_.store(UINT64_MAX);
+            }
+            Unlock();
+        }
+
+        // PendingSince：暂存区中最早一条日志的时间戳下界，没有暂存数据时为UINT64_MAX，不加锁，消费者计算合并水位线时读取
+        uint64_t PendingSince() const { return pending_since_.load(); }
+
+        void Close() { closed_.store(true, std::memory_order_release); } // 所属线程已退出
+        bool Closed() const { return closed_.load(std::memory_order_acquire); }
+
+    private:
+        void FlushLocked() {
+            if (data_.empty())
+                return;
+            if (auto worker = worker_.lock()) // 日志器已经销毁则丢弃
+                worker->PushBatch(data_.data(), data_.size(), records_);
+            data_.clear();
+            records_.clear();
+            levels_ = 0;
+            pending_since_.store(UINT64_MAX); // 数据已在AsyncWorker中，消费者下一次交换缓冲区时一定能取到
+        }
+        void Lock() {
+            while (lock_.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+        void Unlock() { lock_.clear(std::memory_order_release); }
+
+    private:
+        std::weak_ptr<AsyncWorker> worker_; // 目标异步工作器
+        StagingPolicy policy_;              // 暂存策略
+        std::string data_;                  // 暂存的日志
+        uint64_t first_ns_ = 0;             // 暂存区中第一条日志写入的时间
+        std::vector<BatchRecord> records_;  // 暂存的每条日志的位置和等级
+        uint32_t levels_ = 0;               // 暂存的日志等级的掩码
+        std::atomic_flag lock_ = ATOMIC_FLAG_INIT; // 自旋锁
+        std::atomic<bool> closed_{false};   // 所属线程是否已退出
+        std::atomic<uint64_t> pending_since_{UINT64_MAX}; // 暂存数据最早的时间戳下界，见PendingSince
+    };
+
+    // StagingArea：一个日志器的所有线程暂存区
+    class StagingArea {
+    public:
+        using ptr = std::shared_ptr<StagingArea>;
+
+        StagingArea(std::weak_ptr<AsyncWorker> worker, const StagingPolicy& policy)
+            : id_(NextId()), worker_(worker), policy_(policy) {}
+
+        // Local：获取当前线程在本日志器上的暂存区，第一次使用时创建并登记
+        StagingBuffer& Local() {
+            LocalCache& cache = Cache();
+            if (cache.last_id == id_)
+                return *cache.last;
+            for (auto& e : cache.items) {
+                if (e.first == id_) {
+                    cache.last_id = id_;
+                    cache.last = e.second.get();
+                    return *e.second;
+                }
+            }
+            auto buf = std::make_shared<StagingBuffer>(worker_, policy_);
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                buffers_.push_back(buf);
+            }
+            cache.items.emplace_back(id_, buf);
+            cache.last_id = id_;
+            cache.last = buf.get();
+            return *buf;
+        }
+
+        // Collect：消费者线程在收取函数中调用，收取所有线程中滞留过久的暂存数据，并清理已退出线程的暂存区
+        // 返回合并水位线：取当前时间和各暂存区剩余数据时间戳下界中最早的一个，
+        // 在交换缓冲区之前调用，之后才交给消费者的日志时间戳都不早于它
+        uint64_t Collect(AsyncWorker& worker, bool force = false) {
+            uint64_t now = SteadyNowNs();
+            uint64_t watermark = now;
+            std::unique_lock<std::mutex> lock(mtx_);
+            for (auto it = buffers_.begin(); it != buffers_.end();) {
+                (*it)->Collect(worker, now, force);
+                watermark = std::min(watermark, (*it)->PendingSince());
+                if ((*it)->Closed())
+                    it = buffers_.erase(it);
+                else
+                    ++it;
+            }
+            return watermark;
+        }
+
+        // FlushAll：把所有线程的暂存数据交给AsyncWorker，日志器析构前调用
+        // 只在锁内拷贝暂存区列表，交出数据时不持有mtx_：Push可能等待消费者，而消费者收取时要获取mtx_
+        void FlushAll() {
+            std::vector<StagingBuffer::ptr> buffers;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                buffers = buffers_;
+            }
+            for (auto& e : buffers)
+                e->Flush();
+        }
+
+    private:
+        // 线程本地的暂存区表，线程退出时析构，交出剩余数据
+        struct LocalCache {
+            uint64_t last_id = 0;
+            StagingBuffer* last = nullptr;
+            std::vector<std::pair<uint64_t, StagingBuffer::ptr>> items;
+            ~LocalCache() {
+                for (auto& e : items) {
+                    e.second->Flush();
+                    e.second->Close();
+                }
+            }
+        };
+        static LocalCache& Cache() {
+            thread_local LocalCache cache;
+            return cache;
+        }
+        static uint64_t NextId() {
+            static std::atomic<uint64_t> id{0};
+            return ++id; // 用递增的id而不是地址区分日志器，避免地址复用
+        }
+
+    private:
+        uint64_t id_;                        // 日志器暂存区id
+        std::weak_ptr<AsyncWorker> worker_;  // 目标异步工作器
+        StagingPolicy policy_;               // 暂存策略
+        std::mutex mtx_;                     // 保护buffers_
+        std::vector<StagingBuffer::ptr> buffers_; // 所有线程的暂存区
+    };
+
+    // RecordMerger：消费者线程按时间戳合并带记录头的日志
+    // 只输出时间戳早于水位线的日志，其余的留到下一轮，等待其他线程可能更早的日志到达
+    class RecordMerger {
+    public:
+        // Merge：解析data中的记录，与上一轮留下的记录一起按时间排序，把早于watermark的日志正文写入out
+        // 返回写入out的日志等级的掩码
+        uint32_t Merge(const char* data, size_t len, std::string& out, uint64_t watermark) {
+            held_.append(data, len);
+
+            entries_.clear();
+            size_t pos = 0;
+            while (pos + sizeof(StagedRecordHeader) <= held_.size()) {
+                StagedRecordHeader head;
+                memcpy(&head, held_.data() + pos, sizeof(head));
+                entries_.push_back(Entry{head.ts, pos});
+                pos += sizeof(head) + head.len;
+            }
+            // 稳定排序：同一线程的日志时间戳单调不减，排序后仍保持原有顺序
+            std::stable_sort(entries_.begin(), entries_.end(),
+                [](const Entry& a, const Entry& b) { return a.ts < b.ts; });
+
+            std::string rest;
+            uint32_t levels = 0;
+            for (auto& e : entries_) {
+                StagedRecordHeader head;
+                memcpy(&head, held_.data() + e.pos, sizeof(head));
+                if (e.ts < watermark) {
+                    out.append(held_.data() + e.pos + sizeof(head), head.len);
+                    levels |= LogLevel::Bit((LogLevel::value)head.level);
+                } else {
+                    rest.append(held_.data() + e.pos, sizeof(head) + head.len);
+                }
+            }
+            held_.swap(rest);
+            return levels;
+        }
+
+        // Hold：只保存记录不输出，一批数据分成多段时先逐段保存，最后一段再调用Merge
+        void Hold(const char* data, size_t len) { held_.append(data, len); }
+
+        bool HasHeld() const { return !held_.empty(); }
+
+    private:
+        struct Entry {
+            uint64_t ts;  // 时间戳
+            size_t pos;   // 记录在held_中的偏移
+        };
+        std::string held_;           // 尚未输出的记录
+        std::vector<Entry> entries_; // 排序用的索引，复用内存
+    };
+} // namespace mylog
@@ -0,0 +1,116 @@
+/*日志落盘的持久化策略设计*/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include "Level.hpp" // sync_on_error对应的等级
+#include "Util.hpp" // JsonData中的持久化配置
+
+// 声明外部全局变量，用于访问日志配置数据
+extern mylog::Util::JsonData* g_conf_data;
+
+namespace mylog {
+    // 持久化策略：flush_log为2时，不再每批日志都同步磁盘，而是距上次同步超过interval
+    // 或未同步的数据超过bytes时才同步一次（组提交）；两者都为0时退回到每批同步一次
+    // sync_on_error为true时，ERROR/FATAL日志所在的批次写入后立即同步
+    struct SyncPolicy {
+        size_t mode = 0;                       // 对应flush_log：0不处理，1每批fflush，2同步到磁盘
+        std::chrono::milliseconds interval{0}; // 最长同步间隔
+        size_t bytes = 0;                      // 最多累积多少未同步字节
+        bool sync_on_error = false;            // ERROR/FATAL是否立即同步
+
+        static SyncPolicy FromConfig()
+        {
+            SyncPolicy p;
+            p.mode = g_conf_data->flush_log;
+            p.interval = g_conf_data->sync_interval;
+            p.bytes = g_conf_data->sync_bytes;
+            p.sync_on_error = g_conf_data->sync_on_error;
+            return p;
+        }
+        // 是否需要同步磁盘
+        bool Durable() const { return mode == 2; }
+        // 是否按时间/字节分组同步
+        bool Grouped() const { return Durable() && (interval.count() > 0 || bytes > 0); }
+        // 写入后需要立即同步的日志等级的掩码，与一批日志实际写入的等级掩码相交不为空时立即同步
+        uint32_t UrgentLevels() const
+        {
+            return Durable() && sync_on_error ? LogLevel::Range(LogLevel::value::ERROR, LogLevel::value::FATAL) : 0;
+        }
+    };
+
+    // 每个刷新器的同步统计
+    struct SyncStats {
+        size_t syncs = 0;        // 同步次数
+        size_t bytes = 0;        // 同步覆盖的字节数，bytes / syncs即每次同步的平均字节数
+        uint64_t total_ns = 0;   // 同步耗时总和
+        uint64_t max_ns = 0;     // 单次同步最长耗时
+    };
+
+    // SyncController：刷新器中记录未同步的数据量并按策略决定何时同步，只在消费者线程中调用，统计可在任意线程读取
+    class SyncController {
+    public:
+        explicit SyncController(const SyncPolicy& policy = SyncPolicy::FromConfig())
+            : policy_(policy), last_sync_(std::chrono::steady_clock::now()) {}
+
+        const SyncPolicy& Policy() const { return policy_; }
+        // 替换持久化策略，只能在刷新器交给日志器之前调用（消费者线程读取policy_时不加锁）
+        void SetPolicy(const SyncPolicy& policy) { policy_ = policy; }
+
+        // 写入len字节后调用，返回是否需要立即同步
+        bool OnWrite(size_t len)
+        {
+            if (!policy_.Durable())
+                return false;
+            unsynced_ += len;
+            return !policy_.Grouped() || Due();
+        }
+
+        // 是否有尚未同步的数据
+        bool HasUnsynced() const { return unsynced_ > 0; }
+
+        // 是否已经到了该同步的时候
+        bool Due() const
+        {
+            if (unsynced_ == 0)
+                return false;
+            if (policy_.bytes > 0 && unsynced_ >= policy_.bytes)
+                return true;
+            return policy_.interval.count() > 0 && std::chrono::steady_clock::now() - last_sync_ >= policy_.interval;
+        }
+
+        // 执行一次同步并记录耗时
+        template <typename F>
+        void Run(F&& do_sync)
+        {
+            auto start = std::chrono::steady_clock::now();
+            do_sync();
+            last_sync_ = std::chrono::steady_clock::now();
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(last_sync_ - start).count();
+            syncs_.fetch_add(1, std::memory_order_relaxed);
+            bytes_.fetch_add(unsynced_, std::memory_order_relaxed);
+            total_ns_.fetch_add(ns, std::memory_order_relaxed);
+            if (ns > max_ns_.load(std::memory_order_relaxed))
+                max_ns_.store(ns, std::memory_order_relaxed);
+            unsynced_ = 0;
+        }
+
+        SyncStats Stats() const
+        {
+            SyncStats st;
+            st.syncs = syncs_.load(std::memory_order_relaxed);
+            st.bytes = bytes_.load(std::memory_order_relaxed);
+            st.total_ns = total_ns_.load(std::memory_order_relaxed);
+            st.max_ns = max_ns_.load(std::memory_order_relaxed);
+            return st;
+        }
+
+    private:
+        SyncPolicy policy_; // 持久化策略
+        size_t unsynced_ = 0; // 未同步的字节数
+        std::chrono::steady_clock::time_point last_sync_; // 上次同步的时间
+        std::atomic<size_t> syncs_{0};
+        std::atomic<size_t> bytes_{0};
+        std::atomic<uint64_t> total_ns_{0};
+        std::atomic<uint64_t> max_ns_{0};
+    };
+} // namespace mylog
@@ -3,6 +3,7 @@
 #include <sys/types.h>
 #include <jsoncpp/json/json.h>
 
+#include <chrono>
 #include <ctime>
 #include <fstream>
 #include <iostream>
@@ -166,15 +167,43 @@ namespace mylog
                 backup_addr = root["backup_addr"].asString();
                 backup_port = root["backup_port"].asInt();
                 thread_count = root["thread_count"].asInt();
+                ring_capacity = root["ring_capacity"].asInt64();
+                backup_max_pending = root["backup_max_pending"].asInt64();
+                backup_flush_interval = std::chrono::milliseconds(root["backup_flush_interval"].asInt64());
+                backup_spool_dir = root["backup_spool_dir"].asString();
+                backup_spool_segment = root["backup_spool_segment"].asInt64();
+                backup_spool_max = root["backup_spool_max"].asInt64();
+                sync_interval = std::chrono::milliseconds(root["sync_interval"].asInt64());
+                sync_bytes = root["sync_bytes"].asInt64();
+                sync_on_error = root["sync_on_error"].asBool();
+                unsafe_max_buffer = root["unsafe_max_buffer"].asInt64();
+                chunk_size = root["chunk_size"].asInt64();
+                chunk_pool_max = root["chunk_pool_max"].asInt64();
+                time_precision = root["time_precision"].asInt64();
+                sink_queue_max = root["sink_queue_max"].asInt64();
             }
             public:
-                size_t buffer_size;//缓冲区基础容量
-                size_t threshold;// 倍数扩容阈值
-                size_t linear_growth;// 线性增长容量
+                size_t buffer_size;//缓冲区基础容量，ASYNC_SAFE下生产者缓冲区超过该大小时等待
+                size_t threshold;// 倍数扩容阈值，分段缓冲区不再使用
+                size_t linear_growth;// 线性增长容量，分段缓冲区不再使用
                 size_t flush_log;//控制日志同步到磁盘的时机，默认为0,1调用fflush，2调用fsync
 				std::string backup_addr; // 日志备份地址
 				uint16_t backup_port; // 日志备份端口
 				size_t thread_count; // 线程池线程数量
+                size_t ring_capacity; // 无锁环形缓冲区的槽位数量，每个槽位64字节
+                size_t backup_max_pending; // 远程备份待发送队列的字节上限，超过后丢弃新日志
+                std::chrono::milliseconds backup_flush_interval; // 远程备份攒批发送的间隔
+                std::string backup_spool_dir; // 备份服务器不可达时暂存日志的本地目录
+                size_t backup_spool_segment; // 暂存队列单个分段文件的大小上限
+                size_t backup_spool_max; // 暂存队列占用磁盘的总上限，超过后删除最旧的分段
+                std::chrono::milliseconds sync_interval; // flush_log为2时两次同步磁盘的最长间隔，与sync_bytes都为0时每批同步
+                size_t sync_bytes; // flush_log为2时最多累积多少未同步的字节
+                bool sync_on_error; // ERROR/FATAL日志是否立即同步磁盘
+                size_t unsafe_max_buffer; // ASYNC_UNSAFE日志器待消费数据的默认上限，超过后按过载策略丢弃
+                size_t chunk_size; // 缓冲区分段大小
+                size_t chunk_pool_max; // 分段池中保留的空闲分段总字节数上限，超过的部分还给系统
+                size_t time_precision; // 日志时间小数部分的位数，0只到秒，3毫秒，6微秒，9纳秒
+                size_t sink_queue_max; // 刷新器独立队列中待写入数据的字节上限
         };
     } // namespace Util
 } // namespace mylog
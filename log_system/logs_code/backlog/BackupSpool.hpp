@@ -0,0 +1,261 @@
+// 远程备份的本地磁盘暂存队列-发送端
+#pragma once
+#include <iostream> // 标准输入输出
+#include <string> // 字符串操作
+#include <deque> // 按顺序保存暂存段
+#include <vector> // 启动时收集分段编号
+#include <algorithm> // 用于sort
+#include <cstdio> // 用于rename
+#include <cstring> // 用于strerror
+#include <cerrno> // 用于errno
+#include <dirent.h> // 用于遍历暂存目录
+#include <fcntl.h> // 用于open
+#include <sys/stat.h> // 用于stat
+#include <unistd.h> // 用于pread/write/unlink
+#include <arpa/inet.h> // 用于ntohl
+#include "../Util.hpp" // 用于创建目录
+
+namespace mylog {
+    // BackupSpool：备份服务器不可达时，把发不出去的日志按原样（含长度前缀和序号）追加到本地分段文件
+    // 连接恢复后从读取游标处按顺序重放，发送成功后才推进游标并持久化，保证至少送达一次
+    // 所有分段的总大小不超过max_bytes，超过时删除最旧的分段
+    // 只由备份发送线程访问，不加锁
+    class BackupSpool
+    {
+    public:
+        BackupSpool(const std::string& dir, size_t segment_bytes, size_t max_bytes)
+            : dir_(dir), segment_bytes_(segment_bytes), max_bytes_(max_bytes)
+        {
+            Util::File::CreateDirectory(dir_ + "/");
+            Recover();
+        }
+
+        ~BackupSpool()
+        {
+            if (write_fd_ >= 0)
+                close(write_fd_);
+        }
+
+        // 暂存队列中是否还有未发送的日志
+        bool Empty() const
+        {
+            return segments_.empty() || (segments_.size() == 1 && read_off_ >= segments_.front().size);
+        }
+
+        size_t DroppedBytes() const { return dropped_bytes_; } // 因超过磁盘上限被删除的字节数
+
+        // Append：追加一批完整的帧，一批不会跨越两个分段
+        bool Append(const std::string& frames)
+        {
+            if (frames.empty())
+                return true;
+            if (write_fd_ < 0 || segments_.back().size >= segment_bytes_) {
+                if (!OpenSegment())
+                    return false;
+            }
+            size_t written = 0;
+            while (written < frames.size())
+            {
+                ssize_t n = write(write_fd_, frames.data() + written, frames.size() - written);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0) {
+                    std::cout << __FILE__ << __LINE__ << "write spool error : " << strerror(errno) << std::endl;
+                    return false;
+                }
+                written += n;
+            }
+            fdatasync(write_fd_);
+            segments_.back().size += written;
+            total_bytes_ += written;
+            Trim();
+            return true;
+        }
+
+        // Peek：从读取游标处读出最多max字节的完整帧，不推进游标；没有可发送的数据时返回false
+        bool Peek(std::string& out, size_t max)
+        {
+            out.clear();
+            while (!segments_.empty())
+            {
+                Segment& seg = segments_.front();
+                bool active = segments_.size() == 1 && write_fd_ >= 0;
+                size_t remain = seg.size - read_off_;
+                if (remain > 0) {
+                    out.resize(std::min(remain, max));
+                    int fd = open(SegmentPath(seg.id).c_str(), O_RDONLY);
+                    ssize_t n = fd < 0 ? -1 : pread(fd, &out[0], out.size(), read_off_);
+                    if (fd >= 0)
+                        close(fd);
+                    if (n < 0) {
+                        std::cout << __FILE__ << __LINE__ << "read spool error : " << strerror(errno) << std::endl;
+                        out.clear();
+                        return false;
+                    }
+                    out.resize(n);
+                    out.resize(CompleteFrames(out));
+                    if (!out.empty())
+                        return true;
+                    if (remain > max) { // 单帧比max还大，读出分段剩余的全部数据
+                        max = remain;
+                        continue;
+                    }
+                    if (active)
+                        return false;
+                    // 非活动分段末尾只剩不完整的帧（上次进程异常退出时写了一半），跳过
+                }
+                NextSegment();
+            }
+            return false;
+        }
+
+        // Commit：Peek读出的数据已发送成功，推进游标并持久化，读完的分段被删除
+        void Commit(size_t bytes)
+        {
+            if (segments_.empty())
+                return;
+            read_off_ += bytes;
+            if (read_off_ >= segments_.front().size)
+                NextSegment();
+            else
+                SaveCursor();
+        }
+
+    private:
+        struct Segment {
+            uint64_t id;  // 分段编号，递增
+            size_t size;  // 分段大小
+        };
+
+        // 从data开头取完整的帧，返回这些帧的总长度
+        static size_t CompleteFrames(const std::string& data)
+        {
+            size_t pos = 0;
+            while (data.size() - pos >= sizeof(uint32_t))
+            {
+                uint32_t len;
+                memcpy(&len, data.data() + pos, sizeof(len));
+                len = ntohl(len);
+                if (data.size() - pos - sizeof(len) < len)
+                    break;
+                pos += sizeof(len) + len;
+            }
+            return pos;
+        }
+
+        std::string SegmentPath(uint64_t id) const { return dir_ + "/spool-" + std::to_string(id) + ".seg"; }
+        std::string CursorPath() const { return dir_ + "/cursor"; }
+
+        // 启动时恢复：找出目录中已有的分段，读取游标，删除游标之前已发送的分段
+        void Recover()
+        {
+            DIR* d = opendir(dir_.c_str());
+            if (d == nullptr) {
+                std::cout << __FILE__ << __LINE__ << "open spool dir error : " << strerror(errno) << std::endl;
+                return;
+            }
+            std::vector<uint64_t> ids;
+            while (struct dirent* e = readdir(d))
+            {
+                unsigned long long id;
+                char tail;
+                if (sscanf(e->d_name, "spool-%llu.se%c", &id, &tail) == 2 && tail == 'g')
+                    ids.push_back(id);
+            }
+            closedir(d);
+            std::sort(ids.begin(), ids.end());
+
+            unsigned long long cursor_id = 0, cursor_off = 0;
+            if (FILE* fp = fopen(CursorPath().c_str(), "r")) {
+                if (fscanf(fp, "%llu %llu", &cursor_id, &cursor_off) != 2)
+                    cursor_id = cursor_off = 0;
+                fclose(fp);
+            }
+            for (uint64_t id : ids)
+            {
+                if (id < cursor_id) { // 已经发送完的分段
+                    unlink(SegmentPath(id).c_str());
+                    continue;
+                }
+                struct stat st;
+                if (stat(SegmentPath(id).c_str(), &st) < 0)
+                    continue;
+                segments_.push_back(Segment{id, (size_t)st.st_size});
+                total_bytes_ += st.st_size;
+            }
+            if (!segments_.empty() && segments_.front().id == cursor_id)
+                read_off_ = std::min((size_t)cursor_off, segments_.front().size);
+            next_id_ = ids.empty() ? 1 : ids.back() + 1;
+            if (next_id_ < cursor_id) // 暂存队列曾被清空，游标指向的是下一个分段
+                next_id_ = cursor_id;
+        }
+
+        // 打开一个新分段作为写入目标，旧分段不再写入
+        bool OpenSegment()
+        {
+            if (write_fd_ >= 0)
+                close(write_fd_);
+            uint64_t id = next_id_++;
+            write_fd_ = open(SegmentPath(id).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+            if (write_fd_ < 0) {
+                std::cout << __FILE__ << __LINE__ << "open spool segment error : " << strerror(errno) << std::endl;
+                return false;
+            }
+            if (segments_.empty())
+                read_off_ = 0;
+            segments_.push_back(Segment{id, 0});
+            return true;
+        }
+
+        // 删除读取游标所在的分段，游标移到下一个分段开头
+        void NextSegment()
+        {
+            Segment seg = segments_.front();
+            segments_.pop_front();
+            if (segments_.empty() && write_fd_ >= 0) { // 删除的是正在写入的分段
+                close(write_fd_);
+                write_fd_ = -1;
+            }
+            total_bytes_ -= seg.size;
+            read_off_ = 0;
+            SaveCursor(); // 先持久化游标再删文件，进程在两步之间退出也不会重发已删除的数据
+            unlink(SegmentPath(seg.id).c_str());
+        }
+
+        // 超过磁盘上限时删除最旧的分段（不删除正在写入的分段）
+        void Trim()
+        {
+            while (total_bytes_ > max_bytes_ && segments_.size() > 1)
+            {
+                if (dropped_bytes_ == 0)
+                    std::cout << __FILE__ << __LINE__ << "backup spool full, dropping oldest logs" << std::endl;
+                dropped_bytes_ += segments_.front().size - read_off_;
+                NextSegment();
+            }
+        }
+
+        // 游标写入临时文件后rename，保证游标文件总是完整的
+        void SaveCursor()
+        {
+            std::string tmp = CursorPath() + ".tmp";
+            FILE* fp = fopen(tmp.c_str(), "w");
+            if (fp == nullptr)
+                return;
+            uint64_t id = segments_.empty() ? next_id_ : segments_.front().id;
+            fprintf(fp, "%llu %llu\n", (unsigned long long)id, (unsigned long long)read_off_);
+            fclose(fp);
+            rename(tmp.c_str(), CursorPath().c_str());
+        }
+
+    private:
+        std::string dir_; // 暂存目录
+        size_t segment_bytes_; // 单个分段的大小上限
+        size_t max_bytes_; // 所有分段的总大小上限
+        std::deque<Segment> segments_; // 未发送完的分段，按编号排序
+        size_t read_off_ = 0; // 读取游标在第一个分段中的偏移
+        size_t total_bytes_ = 0; // 所有分段的总大小
+        size_t dropped_bytes_ = 0; // 被丢弃的字节数
+        uint64_t next_id_ = 1; // 下一个分段编号
+        int write_fd_ = -1; // 正在写入的分段，总是segments_中的最后一个
+    };
+} // namespace mylog
@@ -1,7 +1,18 @@
 // 远程备份debug等级以上的日志信息-发送端
+#pragma once
 #include <iostream> // 标准输入输出
 #include <cstring> // 用于memset
 #include <string> // 字符串操作
+#include <atomic> // 统计计数
+#include <chrono> // 批量发送间隔和重连退避时间
+#include <condition_variable> // 唤醒发送线程
+#include <mutex> // 保护待发送队列
+#include <thread> // 后台发送线程
+#include <random> // 第一次启动时生成发送端id
+#include <cstdio> // 读写发送端文件和rename
+#include <endian.h> // 用于htobe64
+#include <fcntl.h> // 用于非阻塞connect
+#include <poll.h> // 用于connect超时
 #include <sys/types.h> // 套接字类型
 #include <sys/socket.h> // 套接字函数
 #include <sys/stat.h> // 文件状态，尽管在此文件中未直接使用stat
@@ -9,52 +20,301 @@
 #include <netinet/in.h> // 用于sockaddr_in
 #include <unistd.h> // 用于close
 #include "../Util.hpp" // 包含mylog::Util::JsonData，用于获取配置信息
+#include "../LogFlush.hpp" // BackupFlush作为日志器的刷新器
+#include "BackupSpool.hpp" // 本地磁盘暂存队列
 
 // 声明外部全局变量，用于访问日志配置数据（特别是备份服务器的地址和端口）
 extern mylog::Util::JsonData* g_conf_data;
 
-// start_backup函数：负责创建TCP客户端套接字并发送日志消息到备份服务器
-void start_backup(const std::string& message)
-{
-    // 1. 创建套接字
-    // AF_INET: IPv4协议族
-    // SOCK_STREAM: TCP流式套接字
-    // 0: 默认协议 (TCP)
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) // 检查套接字创建是否成功
+namespace mylog {
+    // BackupClient：日志远程备份的异步发送端，由日志器消费者线程中的BackupFlush提交
+    // 提交时只把一批日志追加到待发送队列，不做任何网络操作；后台线程攒批后通过一条长连接发送
+    // 每一帧前加4字节网络字节序的长度，接收端按长度拆分；连接失败时按指数退避重连
+    // 长度之后是8字节发送端id和8字节序号，接收端据此丢弃重发的日志
+    // 发送端id和已分配序号的上界保存在暂存目录的sender文件中，重启后id不变，序号从上界继续递增
+    // 发不出去的日志写入本地磁盘暂存队列，连接恢复后按顺序重放，暂存队列非空时新日志也先进入暂存队列，保证顺序
+    class BackupClient
     {
-        std::cout << __FILE__ << __LINE__ << "socket error : " << strerror(errno) << std::endl;
-        perror(NULL);
-        return;
-    }
-
-    struct sockaddr_in server; // 定义服务器地址结构体
-    memset(&server, 0, sizeof(server)); // 清零
-    server.sin_family = AF_INET; // 地址族设置为IPv4
-    server.sin_port = htons(g_conf_data->backup_port); // 从全局配置获取备份端口并转换为网络字节序
-    // 将备份服务器IP地址字符串转换为网络字节序的二进制形式
-    inet_aton(g_conf_data->backup_addr.c_str(), &(server.sin_addr));
-
-    // 2. 尝试连接服务器，并实现重连机制
-    int cnt = 5; // 重试连接次数
-    while (-1 == connect(sock, (struct sockaddr*)&server, sizeof(server))) // 尝试建立TCP连接
-    {
-        std::cout << "正在尝试重连,重连次数还有: " << cnt-- << std::endl;
-        if (cnt <= 0) // 重试次数耗尽，连接失败
+    public:
+        static constexpr size_t kFrameHeader = 4 + 8 + 8; // 长度前缀、发送端id、序号的字节数
+
+        static BackupClient& GetInstance()
+        {
+            static BackupClient client; // 第一次备份时才启动发送线程
+            return client;
+        }
+
+        // Submit：提交一帧待备份的日志（可以包含多行），只在待发送队列上短暂加锁，从不等待网络
+        // 队列超过backup_max_pending字节时丢弃这一帧并计数
+        void Submit(const char* data, size_t len)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                if (pending_.size() + kFrameHeader + len > max_pending_) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                uint32_t n = htonl((uint32_t)(len + kFrameHeader - sizeof(uint32_t)));
+                if (seq_ == seq_limit_) // 每kSeqBlock个序号才写一次磁盘
+                    ReserveSeq();
+                uint64_t sender = htobe64(sender_id_);
+                uint64_t seq = htobe64(++seq_);
+                pending_.append((const char*)&n, sizeof(n));
+                pending_.append((const char*)&sender, sizeof(sender));
+                pending_.append((const char*)&seq, sizeof(seq));
+                pending_.append(data, len);
+            }
+            submitted_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        size_t SubmittedCount() const { return submitted_.load(std::memory_order_relaxed); } // 已提交的帧数
+        size_t DroppedCount() const { return dropped_.load(std::memory_order_relaxed); } // 队列满被丢弃的帧数
+        size_t ReconnectCount() const { return reconnects_.load(std::memory_order_relaxed); } // 建立连接的次数
+        size_t SpooledCount() const { return spooled_.load(std::memory_order_relaxed); } // 写入磁盘暂存队列的批次数
+
+        ~BackupClient()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                stop_ = true;
+            }
+            cond_.notify_all();
+            if (thread_.joinable())
+                thread_.join();
+            if (sock_ >= 0)
+                close(sock_);
+        }
+
+    private:
+        BackupClient()
+            : max_pending_(g_conf_data->backup_max_pending),
+            interval_(g_conf_data->backup_flush_interval),
+            spool_(g_conf_data->backup_spool_dir, g_conf_data->backup_spool_segment, g_conf_data->backup_spool_max),
+            thread_(&BackupClient::ThreadEntry, this)
+        {
+            LoadSender(); // Submit只能在GetInstance返回后调用，发送线程不访问序号
+        }
+        BackupClient(const BackupClient&) = delete;
+        BackupClient& operator=(const BackupClient&) = delete;
+
+        std::string SenderPath() const { return g_conf_data->backup_spool_dir + "/sender"; }
+
+        // 读取sender文件中的发送端id和序号上界，文件不存在时生成新的id，序号从0开始
+        // 上次运行分配的序号都不超过上界，从上界继续分配，接收端不会把重启后的日志当成重复的丢弃
+        void LoadSender()
+        {
+            unsigned long long id = 0, limit = 0;
+            FILE* fp = fopen(SenderPath().c_str(), "r");
+            if (fp == nullptr || fscanf(fp, "%llu %llu", &id, &limit) != 2) {
+                id = std::random_device()() * 0x100000000ull + std::random_device()();
+                limit = 0;
+            }
+            if (fp)
+                fclose(fp);
+            sender_id_ = id;
+            seq_ = seq_limit_ = limit;
+        }
+
+        // 预留下一段kSeqBlock个序号：先把新的上界同步到sender文件再使用，进程崩溃也不会重用序号
+        // 写入临时文件后rename，保证sender文件总是完整的
+        void ReserveSeq()
+        {
+            uint64_t limit = seq_limit_ + kSeqBlock;
+            std::string tmp = SenderPath() + ".tmp";
+            FILE* fp = fopen(tmp.c_str(), "w");
+            if (fp == nullptr) {
+                std::cout << __FILE__ << __LINE__ << "open sender file error : " << strerror(errno) << std::endl;
+            } else {
+                fprintf(fp, "%llu %llu\n", (unsigned long long)sender_id_, (unsigned long long)limit);
+                fflush(fp);
+                fdatasync(fileno(fp));
+                fclose(fp);
+                rename(tmp.c_str(), SenderPath().c_str());
+            }
+            seq_limit_ = limit; // 写入失败时仍然继续发送，只是重启后可能被当成重复的日志
+        }
+
+        // 发送线程：每隔interval_把队列中的日志整批取出发送
+        // 发送失败的一批写入暂存队列，退避期间新日志也只写入暂存队列，到时间后再连接并重放
+        void ThreadEntry()
+        {
+            std::string batch;
+            std::chrono::milliseconds backoff = kMinBackoff;
+            auto next_try = std::chrono::steady_clock::now();
+            while (true)
+            {
+                bool stopping;
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    cond_.wait_for(lock, interval_, [this]() { return stop_; });
+                    batch.swap(pending_);
+                    stopping = stop_;
+                }
+                // 退出时也做最后一次尝试，发不出去的日志留在暂存队列中，下次启动后重放
+                bool may_send = stopping || std::chrono::steady_clock::now() >= next_try;
+                bool failed = false;
+                if (!batch.empty()) {
+                    if (spool_.Empty() && may_send && SendBatch(batch)) {
+                        // 直接发送成功
+                    } else {
+                        failed = may_send && spool_.Empty();
+                        if (spool_.Append(batch)) // 写入失败时已打印错误，这一批日志丢失
+                            spooled_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    batch.clear();
+                }
+                if (!failed && may_send && !spool_.Empty())
+                    failed = !Replay();
+
+                if (failed) {
+                    next_try = std::chrono::steady_clock::now() + backoff;
+                    backoff = std::min(backoff * 2, kMaxBackoff);
+                } else if (may_send) {
+                    backoff = kMinBackoff;
+                }
+                if (stopping)
+                    break;
+            }
+        }
+
+        // 从暂存队列按顺序重放，每段发送成功后才推进游标；返回是否全部发送成功
+        bool Replay()
         {
-            std::cout << __FILE__ << __LINE__ << "connect error : " << strerror(errno) << std::endl;
-            close(sock); // 关闭套接字
-            perror(NULL);
-            return; // 退出函数
+            std::string chunk;
+            while (spool_.Peek(chunk, kReplayChunk))
+            {
+                if (!SendBatch(chunk))
+                    return false;
+                spool_.Commit(chunk.size());
+            }
+            return true;
         }
-    }
 
-    // 3. 连接成功，发送数据
-    // char buffer[1024]; // 此缓冲区在此处未被使用，可能为残留代码
-    if (-1 == write(sock, message.c_str(), message.size())) // 通过套接字发送日志消息
+        // 发送一批日志，必要时先建立连接；失败时关闭连接，下次重新连接
+        bool SendBatch(const std::string& batch)
+        {
+            if (sock_ < 0 && !Connect())
+                return false;
+            size_t sent = 0;
+            while (sent < batch.size())
+            {
+                ssize_t n = send(sock_, batch.data() + sent, batch.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0) {
+                    std::cout << __FILE__ << __LINE__ << "send to server error : " << strerror(errno) << std::endl;
+                    close(sock_);
+                    sock_ = -1;
+                    return false;
+                }
+                sent += n;
+            }
+            return true;
+        }
+
+        // 非阻塞connect加超时，备份服务器不可达时不会卡住发送线程太久
+        bool Connect()
+        {
+            int sock = socket(AF_INET, SOCK_STREAM, 0);
+            if (sock < 0) {
+                std::cout << __FILE__ << __LINE__ << "socket error : " << strerror(errno) << std::endl;
+                return false;
+            }
+            struct sockaddr_in server; // 定义服务器地址结构体
+            memset(&server, 0, sizeof(server));
+            server.sin_family = AF_INET;
+            server.sin_port = htons(g_conf_data->backup_port);
+            inet_aton(g_conf_data->backup_addr.c_str(), &(server.sin_addr));
+
+            int flags = fcntl(sock, F_GETFL, 0);
+            fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+            int ret = connect(sock, (struct sockaddr*)&server, sizeof(server));
+            if (ret < 0 && errno == EINPROGRESS) {
+                struct pollfd pfd = {sock, POLLOUT, 0};
+                int err = 0;
+                socklen_t len = sizeof(err);
+                if (poll(&pfd, 1, kConnectTimeoutMs) == 1 &&
+                    getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0)
+                    ret = 0;
+                else
+                    errno = err ? err : ETIMEDOUT;
+            }
+            if (ret < 0) {
+                if (!connect_failed_) // 只在第一次失败时打印，避免备份服务器宕机期间刷屏
+                    std::cout << __FILE__ << __LINE__ << "connect error : " << strerror(errno) << std::endl;
+                connect_failed_ = true;
+                close(sock);
+                return false;
+            }
+            fcntl(sock, F_SETFL, flags); // 恢复阻塞模式，发送超时交给SO_SNDTIMEO
+            struct timeval tv = {kSendTimeoutSec, 0};
+            setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+            connect_failed_ = false;
+            reconnects_.fetch_add(1, std::memory_order_relaxed);
+            sock_ = sock;
+            return true;
+        }
+
+    private:
+        static constexpr std::chrono::milliseconds kMinBackoff{100}; // 初始重连间隔
+        static constexpr std::chrono::milliseconds kMaxBackoff{5000}; // 最大重连间隔
+        static constexpr int kConnectTimeoutMs = 1000; // connect超时
+        static constexpr int kSendTimeoutSec = 5; // send超时
+        static constexpr size_t kReplayChunk = 1024 * 1024; // 重放时每次发送的字节数
+        static constexpr uint64_t kSeqBlock = 65536; // 每次预留的序号数量
+
+        std::mutex mtx_; // 保护pending_和stop_
+        std::condition_variable cond_; // 通知发送线程退出
+        std::string pending_; // 待发送的日志，已加长度前缀
+        bool stop_ = false; // 是否退出
+        size_t max_pending_; // 待发送队列的字节上限
+        std::chrono::milliseconds interval_; // 攒批发送的间隔
+        uint64_t sender_id_ = 0; // 发送端id，第一次启动时随机生成并保存在sender文件中，与序号一起唯一标识一条日志
+        uint64_t seq_ = 0; // 最近分配的序号，受mtx_保护
+        uint64_t seq_limit_ = 0; // sender文件中已预留的序号上界，受mtx_保护
+        BackupSpool spool_; // 磁盘暂存队列，只有发送线程访问
+        int sock_ = -1; // 长连接，只有发送线程访问
+        bool connect_failed_ = false; // 上一次连接是否失败
+        std::atomic<size_t> submitted_{0};
+        std::atomic<size_t> dropped_{0};
+        std::atomic<size_t> reconnects_{0};
+        std::atomic<size_t> spooled_{0};
+        std::thread thread_; // 发送线程，最后初始化
+    };
+
+    // BackupFlush：远程备份刷新器，由LoggerBuilder::BuildBackup添加，只接收ERROR/FATAL
+    // 在消费者线程中把一批日志按行切成不超过kMaxFrame的帧交给BackupClient，生产者线程不参与备份
+    class BackupFlush : public LogFlush
     {
-        std::cout << __FILE__ << __LINE__ << "send to server error : " << strerror(errno) << std::endl;
-        perror(NULL);
-    }
-    close(sock); // 发送完毕后关闭套接字
-}
\ No newline at end of file
+    public:
+        using ptr = std::shared_ptr<BackupFlush>;
+        static constexpr size_t kMaxFrame = 1024 * 1024; // 每帧的最大字节数，单行超过时整行一帧
+
+        void Flush(const char* data, size_t len) override
+        {
+            struct iovec iov = {(void*)data, len};
+            FlushV(&iov, 1);
+        }
+
+        void FlushV(const struct iovec* iov, int iovcnt) override
+        {
+            batch_.clear();
+            for (int i = 0; i < iovcnt; ++i)
+                batch_.append((const char*)iov[i].iov_base, iov[i].iov_len);
+            size_t pos = 0;
+            while (pos < batch_.size())
+            {
+                size_t len = batch_.size() - pos;
+                if (len > kMaxFrame) { // 在最后一个完整行之后切开
+                    size_t nl = batch_.rfind('\n', pos + kMaxFrame - 1);
+                    len = nl != std::string::npos && nl >= pos ? nl + 1 - pos : kMaxFrame;
+                }
+                BackupClient::GetInstance().Submit(batch_.data() + pos, len);
+                pos += len;
+            }
+        }
+
+    private:
+        std::string batch_; // 本批日志，复用内存
+    };
+} // namespace mylog
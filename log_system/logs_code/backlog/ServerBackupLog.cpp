@@ -10,7 +10,7 @@
 #include <sys/types.h> // 用于stat类型
 #include <sys/socket.h> // 用于套接字编程
 #include <netinet/in.h> // 用于网络地址结构
-#include "ServerBackupLog.hpp" // 包含TcpServer和ThreadData定义
+#include "ServerBackupLog.hpp" // 包含TcpServer和GroupCommitWriter定义
 
 using std::cout;
 using std::endl;
@@ -20,7 +20,7 @@ const std::string filename = "./logfile.log"; // 定义日志备份文件的名
 // usage函数：打印程序使用说明
 void usage(std::string procgress)
 {
-    cout << "usage error:" << procgress << "port" << endl;
+    cout << "usage error:" << procgress << " port [io_threads]" << endl;
 }
 
 // file_exist函数：检查文件是否存在（此处未被main函数直接使用）
@@ -30,32 +30,21 @@ bool file_exist(const std::string& name)
     return (stat(name.c_str(), &exist) == 0);
 }
 
-// backup_log函数：用作TcpServer的回调函数，将接收到的日志消息写入文件
-void backup_log(const std::string& message) // 用作回调
+// 备份文件写入器，整个进程只打开一次备份文件
+GroupCommitWriter* writer = nullptr;
+
+// backup_log函数：用作TcpServer的回调函数，将接收到的日志消息及其中每个发送端的最大序号交给写入器
+// 多个I/O线程会并发调用，写入器内部加锁，攒批后一次写入并同步磁盘，之后再持久化序号
+void backup_log(const std::string& message, const SeqMarks& marks) // 用作回调
 {
-    // 以追加二进制模式打开日志文件
-    FILE* fp = fopen(filename.c_str(), "ab");
-    if (fp == NULL) // 检查文件是否成功打开
-    {
-        perror("fopen error: ");
-        assert(false); // 如果文件无法打开，触发断言
-    }
-    // 将接收到的日志消息写入文件
-    int write_byte = fwrite(message.c_str(), 1, message.size(), fp);
-    if (write_byte != message.size()) // 检查是否所有字节都成功写入
-    {
-        perror("fwrite error: ");
-        assert(false); // 如果写入失败，触发断言
-    }
-    fflush(fp); // 刷新文件缓冲区到操作系统
-    fclose(fp); // 关闭文件
+    writer->Append(message, marks);
 }
 
 // main函数：日志备份服务器的程序入口
 int main(int args, char* argv[])
 {
-    // 检查命令行参数数量，需要一个端口号参数
-    if (args != 2)
+    // 检查命令行参数数量，需要一个端口号参数，I/O线程数量可选
+    if (args != 2 && args != 3)
     {
         usage(argv[0]); // 打印使用说明
         perror("usage error");
@@ -63,8 +52,10 @@ int main(int args, char* argv[])
     }
 
     uint16_t port = atoi(argv[1]); // 从命令行参数获取端口号并转换为整数
-    // 创建TcpServer实例，传入端口号和backup_log作为回调函数
-    std::unique_ptr<TcpServer> tcp(new TcpServer(port, backup_log));
+    size_t io_threads = args == 3 ? atoi(argv[2]) : 4; // I/O线程数量，默认4个
+    writer = new GroupCommitWriter(filename);
+    // 创建TcpServer实例，传入端口号和backup_log作为回调函数，去重表从上次运行保存的序号恢复
+    std::unique_ptr<TcpServer> tcp(new TcpServer(port, backup_log, io_threads, writer->LastSeq()));
 
     tcp->init_service(); // 初始化TCP服务器的套接字
     tcp->start_service(); // 启动TCP服务器的主循环，开始接受连接
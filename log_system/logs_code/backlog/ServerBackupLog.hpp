@@ -1,49 +1,189 @@
 #pragma once
 #include <iostream> // 用于标准输入输出
 #include <string> // 用于字符串操作
+#include <vector> // 用于保存I/O线程
+#include <thread> // 用于I/O线程和写文件线程
+#include <atomic> // 用于退出标志和轮询分发
+#include <mutex> // 用于保护待写入数据
+#include <condition_variable> // 用于唤醒写文件线程
 #include <unistd.h> // 用于close函数
 #include <cstring> // 用于memset
 #include <cerrno> // 用于errno
 #include <cstdlib> // 用于exit函数
-#include <pthread.h> // 用于多线程编程
-#include <mutex> // 用于互斥锁，尽管此处未直接使用std::mutex，但pthread_mutex_t是其底层实现
+#include <fcntl.h> // 用于设置非阻塞和打开文件
+#include <sys/epoll.h> // 用于epoll事件循环
 #include <sys/socket.h> // 用于套接字编程
 #include <sys/types.h> // 用于socket类型
 #include <netinet/in.h> // 用于sockaddr_in结构
 #include <arpa/inet.h> // 用于inet_ntoa函数
 #include <functional> // 用于std::function
+#include <algorithm> // 用于std::min
+#include <unordered_map> // 用于记录每个发送端已收到的最大序号
+#include <endian.h> // 用于be64toh
+#include <cstdio> // 用于读写序号文件和rename
 
 using std::cout;
 using std::endl;
 
-using func_t = std::function<void(const std::string&)>; // 定义回调函数类型，用于处理接收到的数据
+using SeqMarks = std::unordered_map<uint64_t, uint64_t>; // 发送端id -> 该发送端已收到的最大序号
+using func_t = std::function<void(const std::string&, const SeqMarks&)>; // 定义回调函数类型，用于处理接收到的数据及其中每个发送端的最大序号
 const int backlog = 32; // 定义listen函数的backlog参数，表示等待连接队列的最大长度
+const uint32_t kMaxFrameSize = 64 * 1024 * 1024; // 单条日志的长度上限，超过视为协议错误并断开连接
+const uint32_t kSeqHeaderSize = 8 + 8; // 长度之后的发送端id和序号，与发送端一致
+const size_t kMaxReadPerWakeup = 256 * 1024; // 每个连接每次唤醒最多读取的字节数
 
-class TcpServer; // 前向声明TcpServer类
+// MergeSeq函数：把from中每个发送端的序号合并到to，保留较大的一个
+inline void MergeSeq(SeqMarks& to, const SeqMarks& from)
+{
+    for (auto& m : from) {
+        uint64_t& last = to[m.first];
+        if (m.second > last)
+            last = m.second;
+    }
+}
 
-// ThreadData类：包含传递给新线程的客户端连接信息和TcpServer实例指针
-class ThreadData
+// GroupCommitWriter类：长期打开的追加写文件器
+// 各I/O线程只把数据追加到内存中，写文件线程把这段时间内攒下的数据一次write并fdatasync（组提交）
+// 每个发送端已收到的最大序号保存在备份文件旁的filename.seq中，服务端重启后据此继续去重；
+// 序号文件只在对应的数据fdatasync之后才更新，进程崩溃时最多重复写入，不会丢失日志
+class GroupCommitWriter
 {
 public:
-    // 构造函数
-    ThreadData(int fd, const std::string& ip, const uint16_t& port, TcpServer* ts)
-        : sock(fd), client_ip(ip), client_port(port), ts_(ts) {
+    explicit GroupCommitWriter(const std::string& filename)
+        : seq_path_(filename + ".seq")
+    {
+        fd_ = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd_ < 0) {
+            std::cout << __FILE__ << __LINE__ << "open backup file error" << strerror(errno) << std::endl;
+            exit(-1);
+        }
+        LoadSeq();
+        thread_ = std::thread(&GroupCommitWriter::ThreadEntry, this);
     }
 
-public:
-    int sock; // 客户端连接套接字文件描述符
-    std::string client_ip; // 客户端IP地址
-    uint16_t client_port; // 客户端端口号
-    TcpServer* ts_; // 指向TcpServer实例的指针，以便线程可以调用其成员方法
+    // LastSeq方法：启动时从序号文件读到的每个发送端的最大序号，用于初始化TcpServer的去重表
+    SeqMarks LastSeq()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return saved_seq_;
+    }
+
+    // Append方法：追加一段数据及其中每个发送端的最大序号，不做磁盘I/O
+    void Append(const std::string& data, const SeqMarks& marks)
+    {
+        if (data.empty())
+            return;
+        std::unique_lock<std::mutex> lock(mtx_);
+        bool was_empty = pending_.empty();
+        pending_.append(data);
+        MergeSeq(pending_seq_, marks);
+        if (was_empty) // 写文件线程只在没有数据时等待
+            cond_.notify_one();
+    }
+
+    ~GroupCommitWriter()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cond_.notify_one();
+        thread_.join();
+        close(fd_);
+    }
+
+private:
+    void ThreadEntry()
+    {
+        std::string writing; // 本组要写入的数据，只有写文件线程访问
+        SeqMarks marks; // 本组数据中每个发送端的最大序号
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cond_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+                if (pending_.empty() && stop_)
+                    return;
+                writing.swap(pending_);
+                marks.swap(pending_seq_);
+            }
+            size_t written = 0;
+            while (written < writing.size())
+            {
+                ssize_t n = write(fd_, writing.data() + written, writing.size() - written);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0) {
+                    perror("write error: ");
+                    break;
+                }
+                written += n;
+            }
+            bool durable = written == writing.size();
+            if (fdatasync(fd_) < 0) { // 整组数据只同步一次
+                perror("fdatasync error: ");
+                durable = false;
+            }
+            if (durable && !marks.empty()) { // 数据落盘之后才记录序号，写失败的这组允许发送端重发
+                std::unique_lock<std::mutex> lock(mtx_);
+                MergeSeq(saved_seq_, marks);
+                SaveSeq();
+            }
+            writing.clear();
+            marks.clear();
+        }
+    }
+
+    // 序号文件每行是一个发送端id和它的最大序号
+    void LoadSeq()
+    {
+        FILE* fp = fopen(seq_path_.c_str(), "r");
+        if (fp == nullptr)
+            return;
+        unsigned long long sender, seq;
+        while (fscanf(fp, "%llu %llu", &sender, &seq) == 2)
+            saved_seq_[sender] = seq;
+        fclose(fp);
+    }
+
+    // 写入临时文件并同步后rename，保证序号文件总是完整的
+    void SaveSeq()
+    {
+        std::string tmp = seq_path_ + ".tmp";
+        FILE* fp = fopen(tmp.c_str(), "w");
+        if (fp == nullptr) {
+            perror("open seq file error: ");
+            return;
+        }
+        for (auto& m : saved_seq_)
+            fprintf(fp, "%llu %llu\n", (unsigned long long)m.first, (unsigned long long)m.second);
+        fflush(fp);
+        fdatasync(fileno(fp));
+        fclose(fp);
+        if (rename(tmp.c_str(), seq_path_.c_str()) < 0)
+            perror("rename seq file error: ");
+    }
+
+private:
+    int fd_ = -1; // 备份文件描述符，程序运行期间一直打开
+    std::mutex mtx_; // 保护pending_和stop_
+    std::condition_variable cond_; // 有数据时唤醒写文件线程
+    std::string pending_; // 等待写入的数据
+    SeqMarks pending_seq_; // pending_中每个发送端的最大序号
+    std::string seq_path_; // 序号文件路径
+    SeqMarks saved_seq_; // 已落盘的每个发送端的最大序号，受mtx_保护
+    bool stop_ = false; // 是否退出
+    std::thread thread_; // 写文件线程
 };
 
-// TcpServer类：实现一个简单的多线程TCP服务器
+// TcpServer类：基于epoll的TCP服务器
+// 主线程负责accept，新连接按轮询分给若干I/O线程，每个I/O线程用自己的epoll监听所属连接
 class TcpServer
 {
 public:
-    // 构造函数：初始化服务器监听端口和数据处理回调函数
-    TcpServer(uint16_t port, func_t func)
-        : port_(port), func_(func)
+    // 构造函数：初始化服务器监听端口、数据处理回调函数、I/O线程数量和上次运行时每个发送端已收到的最大序号
+    TcpServer(uint16_t port, func_t func, size_t io_threads = 4, SeqMarks last_seq = SeqMarks())
+        : port_(port), func_(func), io_threads_(io_threads ? io_threads : 1), last_seq_(std::move(last_seq))
     {
     }
 
@@ -55,6 +195,8 @@ public:
         if (listen_sock_ == -1) {
             std::cout << __FILE__ << __LINE__ << "create socket error" << strerror(errno) << std::endl;
         }
+        int opt = 1;
+        setsockopt(listen_sock_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)); // 重启后可以立即重新绑定端口
 
         struct sockaddr_in local; // 定义服务器地址结构
         memset(&local, 0, sizeof(local)); // 清零
@@ -73,30 +215,31 @@ public:
         }
     }
 
-    // threadRoutine方法：新创建线程的入口点 (静态方法，符合pthread_create要求)
-    static void* threadRoutine(void* args)
-    {
-        pthread_detach(pthread_self()); // 将线程设置为分离状态，使其资源在结束后自动释放，防止在主线程阻塞等待
-
-        ThreadData* td = static_cast<ThreadData*>(args); // 将void*参数转换为ThreadData指针
-        std::string client_info = td->client_ip + ":" + std::to_string(td->client_port); // 格式化客户端IP和端口信息
-        td->ts_->service(td->sock, move(client_info)); // 调用TcpServer实例的service方法处理连接
-        close(td->sock); // 关闭客户端连接套接字
-        delete td; // 释放ThreadData内存
-        return nullptr;
-    }
-
-    // start_service方法：服务器主循环，接受并分发连接
+    // start_service方法：启动I/O线程，主线程循环accept并分发连接
     void start_service()
     {
+        for (size_t i = 0; i < io_threads_; ++i)
+        {
+            int epfd = epoll_create1(EPOLL_CLOEXEC);
+            if (epfd < 0) {
+                std::cout << __FILE__ << __LINE__ << "epoll_create error" << strerror(errno) << std::endl;
+                exit(-1);
+            }
+            epfds_.push_back(epfd);
+        }
+        for (size_t i = 0; i < io_threads_; ++i)
+            threads_.emplace_back(&TcpServer::IoLoop, this, epfds_[i]);
+
+        size_t next = 0; // 轮询分发
         while (true) // 无限循环，持续接受连接
         {
             struct sockaddr_in client_addr; // 用于存储客户端地址信息
             socklen_t client_addrlen = sizeof(client_addr);
             // 接受客户端连接，返回一个新的套接字文件描述符connfd
-            int connfd = accept(listen_sock_, (struct sockaddr*)&client_addr, &client_addrlen);
+            int connfd = accept4(listen_sock_, (struct sockaddr*)&client_addr, &client_addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
             if (connfd < 0) {
-                std::cout << __FILE__ << __LINE__ << "accept error" << strerror(errno) << std::endl;
+                if (errno != EINTR)
+                    std::cout << __FILE__ << __LINE__ << "accept error" << strerror(errno) << std::endl;
                 continue; // 接受失败，继续下一次循环
             }
 
@@ -104,34 +247,143 @@ public:
             std::string client_ip = inet_ntoa(client_addr.sin_addr); // 将网络字节序IP转换为字符串
             uint16_t client_port = ntohs(client_addr.sin_port); // 将网络字节序端口转换为主机字节序
 
-            // 为每个客户端连接创建一个新线程来提供服务
-			pthread_t tid; // 线程ID pthread_t 是 POSIX 线程（pthread）库中用于表示线程ID的数据类型
-            ThreadData* td = new ThreadData(connfd, client_ip, client_port, this); // 创建ThreadData对象传递给线程
-            pthread_create(&tid, nullptr, threadRoutine, td); // 创建线程
+            // 交给下一个I/O线程，之后该连接只由这个I/O线程访问
+            Connection* conn = new Connection{connfd, client_ip + ":" + std::to_string(client_port), std::string()};
+            struct epoll_event ev;
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.ptr = conn;
+            if (epoll_ctl(epfds_[next], EPOLL_CTL_ADD, connfd, &ev) < 0) {
+                std::cout << __FILE__ << __LINE__ << "epoll_ctl error" << strerror(errno) << std::endl;
+                close(connfd);
+                delete conn;
+                continue;
+            }
+            next = (next + 1) % io_threads_;
         }
     }
 
-    // service方法：处理单个客户端连接的实际逻辑 (由工作线程调用)
-    void service(int sock, const std::string&& client_info)
+    // 默认析构函数，这里没有显式定义，但如果需要清理资源应显式定义
+    ~TcpServer() = default;
+
+private:
+    // 一个客户端连接的状态
+    struct Connection
+    {
+        int sock; // 客户端连接套接字文件描述符
+        std::string client_info; // 客户端IP:端口
+        std::string in; // 已收到但尚未拆分的数据
+    };
+
+    // IoLoop方法：I/O线程的事件循环
+    void IoLoop(int epfd)
     {
-        char buf[1024]; // 缓冲区
+        const int kMaxEvents = 64;
+        struct epoll_event events[kMaxEvents];
+        std::string out; // 一次读取拆分出的所有日志，合并后只调用一次回调
+        SeqMarks marks; // out中每个发送端的最大序号
+        while (true)
+        {
+            int n = epoll_wait(epfd, events, kMaxEvents, -1);
+            if (n < 0) {
+                if (errno != EINTR)
+                    std::cout << __FILE__ << __LINE__ << "epoll_wait error" << strerror(errno) << std::endl;
+                continue;
+            }
+            for (int i = 0; i < n; ++i)
+            {
+                Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+                bool alive = service(conn, out, marks);
+                if (!out.empty()) {
+                    func_(out, marks); // 调用回调函数处理接收到的数据，通常是写入日志文件
+                    out.clear();
+                }
+                marks.clear();
+                if (!alive) {
+                    epoll_ctl(epfd, EPOLL_CTL_DEL, conn->sock, nullptr);
+                    close(conn->sock);
+                    delete conn;
+                }
+            }
+        }
+    }
 
-        int r_ret = read(sock, buf, sizeof(buf)); // 从客户端套接字读取数据
-        if (r_ret == -1) {
-            std::cout << __FILE__ << __LINE__ << "read error" << strerror(errno) << std::endl;
-            perror("NULL");
+    // service方法：读取连接上的可读数据，每读到一段就按长度前缀拆出完整的日志追加到out
+    // 每条日志前有4字节网络字节序的长度，之后是8字节发送端id和8字节序号；连接关闭或出错时返回false
+    // 长度前缀一到就检查，超长的帧立即断开，未拆分的数据最多是一个合法帧加一次读取的大小
+    // 每次唤醒最多读kMaxReadPerWakeup字节，epoll是水平触发的，没读完的连接下一轮还会就绪，
+    // 同一I/O线程上的其他连接不会被一个发送很快的连接饿死
+    bool service(Connection* conn, std::string& out, SeqMarks& marks)
+    {
+        char buf[64 * 1024]; // 缓冲区
+        size_t budget = kMaxReadPerWakeup; // 本次唤醒还能读取的字节数
+        while (budget > 0)
+        {
+            ssize_t r_ret = read(conn->sock, buf, std::min(sizeof(buf), budget)); // 非阻塞读取
+            if (r_ret > 0) {
+                budget -= r_ret;
+                conn->in.append(buf, r_ret);
+                if (!parse(conn, out, marks))
+                    return false;
+                continue;
+            }
+            if (r_ret == -1 && errno == EINTR)
+                continue;
+            if (r_ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (r_ret == -1)
+                std::cout << __FILE__ << __LINE__ << "read error" << strerror(errno) << std::endl;
+            return false; // 对端关闭连接或读取出错
         }
-        else if (r_ret > 0) { // 成功读取到数据
-            buf[r_ret] = 0; // 将读取到的数据以null终止，使其成为C字符串
-            std::string tmp = buf;
-            func_(client_info + tmp); // 调用回调函数处理接收到的数据，通常是写入日志文件
+        return true;
+    }
+
+    // parse方法：按长度前缀拆出完整的帧，不完整的留到下次读取；长度不合法时返回false
+    // 一帧是发送端刷新器的一批日志，可能有多行，每一行前都加上客户端信息
+    // 发送端断线重连后会重发未确认的日志，序号不大于该发送端已收到的最大序号的日志是重复的，直接丢弃
+    // 收下的帧的序号记入marks，随数据一起交给回调，由写入器在数据落盘后持久化
+    bool parse(Connection* conn, std::string& out, SeqMarks& marks)
+    {
+        size_t pos = 0;
+        std::unique_lock<std::mutex> lock(seq_mtx_); // 同一发送端重连后可能落在另一个I/O线程上
+        while (conn->in.size() - pos >= sizeof(uint32_t))
+        {
+            uint32_t len;
+            memcpy(&len, conn->in.data() + pos, sizeof(len));
+            len = ntohl(len);
+            if (len > kMaxFrameSize || len < kSeqHeaderSize) {
+                std::cout << __FILE__ << __LINE__ << "bad frame from " << conn->client_info << std::endl;
+                return false;
+            }
+            if (conn->in.size() - pos - sizeof(len) < len)
+                break;
+            uint64_t sender, seq;
+            memcpy(&sender, conn->in.data() + pos + sizeof(len), sizeof(sender));
+            memcpy(&seq, conn->in.data() + pos + sizeof(len) + sizeof(sender), sizeof(seq));
+            uint64_t& last = last_seq_[be64toh(sender)];
+            if (be64toh(seq) > last) {
+                last = be64toh(seq);
+                marks[be64toh(sender)] = last;
+                size_t begin = pos + sizeof(len) + kSeqHeaderSize, end = pos + sizeof(len) + len;
+                while (begin < end) {
+                    size_t nl = conn->in.find('\n', begin);
+                    size_t stop = nl == std::string::npos || nl >= end ? end : nl + 1;
+                    out.append(conn->client_info).append(conn->in, begin, stop - begin);
+                    begin = stop;
+                }
+            }
+            pos += sizeof(len) + len;
         }
+        conn->in.erase(0, pos);
+        return true;
     }
-    // 默认析构函数，这里没有显式定义，但如果需要清理资源应显式定义
-    ~TcpServer() = default;
 
 private:
     int listen_sock_; // 服务器监听套接字
     uint16_t port_; // 服务器监听端口
-    func_t func_; // 处理接收到数据的回调函数
-};
\ No newline at end of file
+    func_t func_; // 处理接收到数据的回调函数，多个I/O线程会并发调用
+    size_t io_threads_; // I/O线程数量
+    std::vector<int> epfds_; // 每个I/O线程的epoll描述符
+    std::vector<std::thread> threads_; // I/O线程
+    std::mutex seq_mtx_; // 保护last_seq_
+    SeqMarks last_seq_; // 每个发送端已收到的最大序号，启动时从写入器的序号文件恢复
+};
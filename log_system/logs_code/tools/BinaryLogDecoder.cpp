@@ -0,0 +1,52 @@
+// 离线解码BinaryFileFlush写出的二进制日志，还原为文本输出到标准输出
+#include <cstdio> // 文件读取
+#include <cstdlib> // 用于exit
+#include <iostream> // 标准输入输出
+#include <string> // 字符串操作
+#include "../BinaryLog.hpp" // 记录格式和RecordRenderer
+
+using std::cout;
+using std::endl;
+
+// usage函数：打印程序使用说明
+void usage(std::string procgress)
+{
+    cout << "usage error:" << procgress << " [--json] binary_log_file" << endl;
+}
+
+// main函数：逐块读取二进制日志，按记录还原为文本，--json时每行输出一个JSON对象
+int main(int args, char* argv[])
+{
+    bool json = args == 3 && std::string(argv[1]) == "--json";
+    if (args != 2 && !json)
+    {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    FILE* fp = fopen(argv[args - 1], "rb");
+    if (fp == NULL)
+    {
+        perror("fopen error: ");
+        exit(-1);
+    }
+
+    mylog::RecordRenderer renderer; // 调用点信息全部来自文件中的SITE记录
+    mylog::Pattern pattern(json ? mylog::Pattern::kJson : mylog::Pattern::kDefault);
+    std::string data, text;
+    char buf[64 * 1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        data.append(buf, n);
+        size_t used = renderer.Render(data.data(), data.size(), text, pattern);
+        data.erase(0, used); // 末尾不完整的记录留到下一块
+        fwrite(text.data(), 1, text.size(), stdout);
+        text.clear();
+    }
+    fclose(fp);
+
+    if (!data.empty()) // 文件末尾有截断的记录（例如进程异常退出）
+        std::cerr << "truncated record: " << data.size() << " bytes ignored" << endl;
+    return 0;
+}
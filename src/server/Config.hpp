@@ -37,14 +37,14 @@ namespace storage
         Config()
         {
 #ifdef DEBUG_LOG
-            mylog::GetLogger("asynclogger")->Info("Config constructor start"); // 记录开始日志
+            MYLOG_LOGGER("asynclogger")->Info("Config constructor start"); // 记录开始日志
 #endif
             if (ReadConfig() == false) // 尝试读取配置文件
             {
-                mylog::GetLogger("asynclogger")->Fatal("ReadConfig failed"); // 读取失败则记录致命错误
+                MYLOG_LOGGER("asynclogger")->Fatal("ReadConfig failed"); // 读取失败则记录致命错误
                 return;
             }
-            mylog::GetLogger("asynclogger")->Info("ReadConfig complicate"); // 记录完成日志
+            MYLOG_LOGGER("asynclogger")->Info("ReadConfig complicate"); // 记录完成日志
         }
 
     public:
@@ -52,20 +52,20 @@ namespace storage
         bool ReadConfig()
         {
 #ifdef DEBUG_LOG
-            mylog::GetLogger("asynclogger")->Info("ReadConfig start"); // 记录开始日志
+            MYLOG_LOGGER("asynclogger")->Info("ReadConfig start"); // 记录开始日志
 #endif
             storage::FileUtil fu(Config_File); // 使用FileUtil打开配置文件
             std::string content;
             if (!fu.GetContent(&content)) // 读取配置文件内容
             {
-                mylog::GetLogger("asynclogger")->Error("Failed to get content from config file: %s", Config_File);
+                MYLOG_LOGGER("asynclogger")->Error("Failed to get content from config file: %s", Config_File);
                 return false;
             }
 
             Json::Value root;
             // 反序列化JSON内容到Json::Value对象
             if (!storage::JsonUtil::UnSerialize(content, &root)) { // 使用服务器端的JsonUtil
-                mylog::GetLogger("asynclogger")->Error("Failed to deserialize config content.");
+                MYLOG_LOGGER("asynclogger")->Error("Failed to deserialize config content.");
                 return false;
             }
 
@@ -82,7 +82,7 @@ namespace storage
             recycle_info_ = root["recycle_info"].asString();
             recycle_retention_days_ = root["recycle_retention_days"].asInt();
 
-            mylog::GetLogger("asynclogger")->Info("ReadConfig finish"); // 记录完成日志
+            MYLOG_LOGGER("asynclogger")->Info("ReadConfig finish"); // 记录完成日志
             return true;
         }
 
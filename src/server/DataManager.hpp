@@ -21,11 +21,11 @@ namespace storage
         bool NewStorageInfo(const std::string& storage_path)
         {
             // 初始化备份文件的信息
-            mylog::GetLogger("asynclogger")->Info("NewStorageInfo start");
+            MYLOG_LOGGER("asynclogger")->Info("NewStorageInfo start");
             FileUtil f(storage_path);
             if (!f.Exists())
             {
-                mylog::GetLogger("asynclogger")->Info("file not exists");
+                MYLOG_LOGGER("asynclogger")->Info("file not exists");
                 return false;
             }
             mtime_ = f.LastAccessTime();
@@ -36,8 +36,8 @@ namespace storage
             // 下载路径前缀+文件名
             storage::Config* config = storage::Config::GetInstance();
             url_ = config->GetDownloadPrefix() + f.FileName();
-            mylog::GetLogger("asynclogger")->Info("download_url:%s,mtime_:%s,atime_:%s,fsize_:%d", url_.c_str(), ctime(&mtime_), ctime(&atime_), fsize_);
-            mylog::GetLogger("asynclogger")->Info("NewStorageInfo end");
+            MYLOG_LOGGER("asynclogger")->Info("download_url:%s,mtime_:%s,atime_:%s,fsize_:%zu", url_.c_str(), ctime(&mtime_), ctime(&atime_), fsize_);
+            MYLOG_LOGGER("asynclogger")->Info("NewStorageInfo end");
             return true;
         }
     } StorageInfo; // namespace StorageInfo
@@ -55,12 +55,12 @@ namespace storage
         // 构造函数：初始化DataManager，读取配置并加载现有数据
         DataManager()
         {
-            mylog::GetLogger("asynclogger")->Info("DataManager construct start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("DataManager construct start"); // 记录日志
             storage_file_ = storage::Config::GetInstance()->GetStorageInfoFile(); // 从Config获取存储文件路径
             need_persist_ = false; // 在加载数据时不进行持久化
             InitLoad(); // 加载现有数据到内存
             need_persist_ = true; // 加载完成后启用持久化
-            mylog::GetLogger("asynclogger")->Info("DataManager construct end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("DataManager construct end"); // 记录日志
         }
 
         // 析构函数：销毁读写锁
@@ -69,10 +69,10 @@ namespace storage
         // InitLoad方法：程序启动时从文件读取数据到内存
         bool InitLoad()
         {
-            mylog::GetLogger("asynclogger")->Info("init datamanager"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("init datamanager"); // 记录日志
             storage::FileUtil f(storage_file_); // 使用FileUtil操作存储文件
             if (!f.Exists()) { // 如果存储文件不存在，则无需加载
-                mylog::GetLogger("asynclogger")->Info("there is no storage file info need to load");
+                MYLOG_LOGGER("asynclogger")->Info("there is no storage file info need to load");
                 return true;
             }
 
@@ -102,11 +102,11 @@ namespace storage
         // Storage方法：将内存中的数据持久化到文件 (JSON格式)
         bool Storage()
         {
-            mylog::GetLogger("asynclogger")->Info("message storage start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("message storage start"); // 记录日志
             std::vector<StorageInfo> arr;
             if (!GetAll(&arr)) // 获取内存中所有StorageInfo
             {
-                mylog::GetLogger("asynclogger")->Warn("GetAll fail,can't get StorageInfo");
+                MYLOG_LOGGER("asynclogger")->Warn("GetAll fail,can't get StorageInfo");
                 return false;
             }
 
@@ -125,23 +125,23 @@ namespace storage
 
             // 序列化JSON::Value到字符串
             std::string body;
-            mylog::GetLogger("asynclogger")->Info("new message for StorageInfo:%s", body.c_str());
+            MYLOG_LOGGER("asynclogger")->Info("new message for StorageInfo:%s", body.c_str());
             JsonUtil::Serialize(root, &body);
 
             // 将序列化后的字符串写入存储文件
             FileUtil f(storage_file_);
 
             if (f.SetContent(body.c_str(), body.size()) == false) // 使用FileUtil写入文件
-                mylog::GetLogger("asynclogger")->Error("SetContent for StorageInfo Error");
+                MYLOG_LOGGER("asynclogger")->Error("SetContent for StorageInfo Error");
 
-            mylog::GetLogger("asynclogger")->Info("message storage end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("message storage end"); // 记录日志
             return true;
         }
 
         // Insert方法：插入一条新的StorageInfo
         bool Insert(const StorageInfo& info)
         {
-            mylog::GetLogger("asynclogger")->Info("data_message Insert start"); // 记录日志
+            MYLOG_INFO(MYLOG_LOGGER("asynclogger"), "data_message Insert start"); // 记录日志
             {
                 std::unique_lock<std::shared_mutex> lock(rwlock_); // 使用unique_lock加写锁，确保线程安全
                 table_[info.url_] = info; // 插入或更新哈希表项
@@ -149,27 +149,27 @@ namespace storage
             // 如果需要持久化，则调用Storage方法写入文件
             if (need_persist_ == true && Storage() == false)
             {
-                mylog::GetLogger("asynclogger")->Error("data_message Insert:Storage Error");
+                MYLOG_ERROR(MYLOG_LOGGER("asynclogger"), "data_message Insert:Storage Error");
                 return false;
             }
-            mylog::GetLogger("asynclogger")->Info("data_message Insert end"); // 记录日志
+            MYLOG_INFO(MYLOG_LOGGER("asynclogger"), "data_message Insert end"); // 记录日志
             return true;
         }
 
         // Update方法：更新一条现有的StorageInfo (逻辑与Insert类似，只是语义上是更新)
         bool Update(const StorageInfo& info)
         {
-            mylog::GetLogger("asynclogger")->Info("data_message Update start"); // 记录日志
+            MYLOG_INFO(MYLOG_LOGGER("asynclogger"), "data_message Update start"); // 记录日志
             {
                 std::unique_lock<std::shared_mutex> lock(rwlock_); // 加写锁
                 table_[info.url_] = info; // 更新哈希表项
             }            
             if (Storage() == false) // 调用Storage方法持久化
             {
-                mylog::GetLogger("asynclogger")->Error("data_message Update:Storage Error");
+                MYLOG_ERROR(MYLOG_LOGGER("asynclogger"), "data_message Update:Storage Error");
                 return false;
             }
-            mylog::GetLogger("asynclogger")->Info("data_message Update end"); // 记录日志
+            MYLOG_INFO(MYLOG_LOGGER("asynclogger"), "data_message Update end"); // 记录日志
             return true;
         }
 
@@ -212,22 +212,22 @@ namespace storage
 		// Delete方法：删除一条StorageInfo (根据URL)
         bool Delete(const std::string& key)
         {
-            mylog::GetLogger("asynclogger")->Info("data_message Delete start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Delete start"); // 记录日志
             {
                 std::unique_lock<std::shared_mutex> lock(rwlock_); // 加写锁，确保线程安全
                 if (table_.find(key) == table_.end()) // 如果未找到
                 {
-                    mylog::GetLogger("asynclogger")->Warn("data_message Delete: key not found");
+                    MYLOG_LOGGER("asynclogger")->Warn("data_message Delete: key not found");
                     return false; // 返回false表示删除失败
                 }
                 table_.erase(key); // 删除哈希表项
             }
             if (Storage() == false) // 调用Storage方法持久化
             {
-                mylog::GetLogger("asynclogger")->Error("data_message Delete:Storage Error");
+                MYLOG_LOGGER("asynclogger")->Error("data_message Delete:Storage Error");
                 return false;
             }
-            mylog::GetLogger("asynclogger")->Info("data_message Delete end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Delete end"); // 记录日志
             return true; // 返回true表示删除成功
 		}
     }; // namespace DataManager
@@ -242,12 +242,12 @@ namespace storage
     public:
         RecycleManager()
         {
-            mylog::GetLogger("asynclogger")->Info("RecycleManager construct start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("RecycleManager construct start"); // 记录日志
             recycle_file_ = storage::Config::GetInstance()->GetRecycleInfoFile(); // 获取回收站信息文件路径
             need_persist_ = false; // 初始化时不进行持久化
             InitLoad(); // 加载回收站数据
             need_persist_ = true; // 加载完成后启用持久化
-            mylog::GetLogger("asynclogger")->Info("RecycleManager construct end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("RecycleManager construct end"); // 记录日志
         }
 
         ~RecycleManager(){}
@@ -255,10 +255,10 @@ namespace storage
         // InitLoad方法：加载回收站数据
         bool InitLoad()
         {
-            mylog::GetLogger("asynclogger")->Info("init recyclemanager"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("init recyclemanager"); // 记录日志
             storage::FileUtil f(recycle_file_); // 使用FileUtil操作存储文件
             if (!f.Exists()) { // 如果存储文件不存在，则无需加载
-                mylog::GetLogger("asynclogger")->Info("there is no recycle file info need to load");
+                MYLOG_LOGGER("asynclogger")->Info("there is no recycle file info need to load");
                 return true;
             }
 
@@ -290,11 +290,11 @@ namespace storage
         // Storage方法：将内存中的数据持久化到文件 (JSON格式)
         bool Storage()
         {
-            mylog::GetLogger("asynclogger")->Info("message recycle start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("message recycle start"); // 记录日志
             std::vector<StorageInfo> arr;
             if (!GetAll(&arr)) // 获取内存中所有StorageInfo
             {
-                mylog::GetLogger("asynclogger")->Warn("GetAll fail,can't get StorageInfo");
+                MYLOG_LOGGER("asynclogger")->Warn("GetAll fail,can't get StorageInfo");
                 return false;
             }
 
@@ -315,23 +315,23 @@ namespace storage
 
             // 序列化JSON::Value到字符串
             std::string body;
-            mylog::GetLogger("asynclogger")->Info("new message for StorageInfo:%s", body.c_str());
+            MYLOG_LOGGER("asynclogger")->Info("new message for StorageInfo:%s", body.c_str());
             JsonUtil::Serialize(root, &body);
 
             // 将序列化后的字符串写入存储文件
             FileUtil f(recycle_file_);
 
             if (f.SetContent(body.c_str(), body.size()) == false) // 使用FileUtil写入文件
-                mylog::GetLogger("asynclogger")->Error("SetContent for StorageInfo Error");
+                MYLOG_LOGGER("asynclogger")->Error("SetContent for StorageInfo Error");
 
-            mylog::GetLogger("asynclogger")->Info("message storage end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("message storage end"); // 记录日志
             return true;
         }
 
         // Insert方法：插入一条新的StorageInfo
         bool Insert(const StorageInfo& info)
         {
-            mylog::GetLogger("asynclogger")->Info("data_message Insert start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Insert start"); // 记录日志
             {
                 std::unique_lock<std::shared_mutex> lock(rwlock_); // 使用unique_lock加写锁，确保线程安全
                 recycle_table_[info.url_] = info; // 插入或更新哈希表项
@@ -339,27 +339,27 @@ namespace storage
             // 如果需要持久化，则调用Storage方法写入文件
             if (need_persist_ == true && Storage() == false)
             {
-                mylog::GetLogger("asynclogger")->Error("data_message Insert:Storage Error");
+                MYLOG_LOGGER("asynclogger")->Error("data_message Insert:Storage Error");
                 return false;
             }
-            mylog::GetLogger("asynclogger")->Info("data_message Insert end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Insert end"); // 记录日志
             return true;
         }
 
         // Update方法：更新一条现有的StorageInfo (逻辑与Insert类似，只是语义上是更新)
         bool Update(const StorageInfo& info)
         {
-            mylog::GetLogger("asynclogger")->Info("data_message Update start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Update start"); // 记录日志
             {
                 std::unique_lock<std::shared_mutex> lock(rwlock_); // 加写锁
                 recycle_table_[info.url_] = info; // 更新哈希表项
             }            
             if (Storage() == false) // 调用Storage方法持久化
             {
-                mylog::GetLogger("asynclogger")->Error("data_message Update:Storage Error");
+                MYLOG_LOGGER("asynclogger")->Error("data_message Update:Storage Error");
                 return false;
             }
-            mylog::GetLogger("asynclogger")->Info("data_message Update end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Update end"); // 记录日志
             return true;
         }
 
@@ -402,22 +402,22 @@ namespace storage
 		// Delete方法：删除一条StorageInfo (根据URL)
         bool Delete(const std::string& key)
         {
-            mylog::GetLogger("asynclogger")->Info("data_message Delete start"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Delete start"); // 记录日志
             {
                 std::unique_lock<std::shared_mutex> lock(rwlock_); // 加写锁，确保线程安全
                 if (recycle_table_.find(key) == recycle_table_.end()) // 如果未找到
                 {
-                    mylog::GetLogger("asynclogger")->Warn("data_message Delete: key not found");
+                    MYLOG_LOGGER("asynclogger")->Warn("data_message Delete: key not found");
                     return false; // 返回false表示删除失败
                 }
                 recycle_table_.erase(key); // 删除哈希表项
             }
             if (Storage() == false) // 调用Storage方法持久化
             {
-                mylog::GetLogger("asynclogger")->Error("data_message Delete:Storage Error");
+                MYLOG_LOGGER("asynclogger")->Error("data_message Delete:Storage Error");
                 return false;
             }
-            mylog::GetLogger("asynclogger")->Info("data_message Delete end"); // 记录日志
+            MYLOG_LOGGER("asynclogger")->Info("data_message Delete end"); // 记录日志
             return true; // 返回true表示删除成功
 		}
     };
@@ -9,6 +9,7 @@
 #include <fcntl.h> // 文件控制，如open函数
 #include <sys/stat.h> // 文件状态，如open函数
 #include <sys/socket.h> // 套接字相关函数
+#include <chrono> // 处理耗时
 #include <cstring> // 字符串处理
 #include <ctime> // 时间处理
 #include <fstream> // 文件输入输出
@@ -30,14 +31,14 @@ namespace storage {
 Service::Service()
 {
 #ifdef DEBUG_LOG
-    mylog::GetLogger("asynclogger")->Debug("Service start(Construct)"); // 记录调试日志
+    MYLOG_LOGGER("asynclogger")->Debug("Service start(Construct)"); // 记录调试日志
 #endif
     // 从Config单例获取服务器配置
     server_port_ = Config::GetInstance()->GetServerPort();
     server_ip_ = Config::GetInstance()->GetServerIp();
     download_prefix_ = Config::GetInstance()->GetDownloadPrefix();
 #ifdef DEBUG_LOG
-    mylog::GetLogger("asynclogger")->Debug("Service end(Construct)"); // 记录调试日志
+    MYLOG_LOGGER("asynclogger")->Debug("Service end(Construct)"); // 记录调试日志
 #endif
 }
 
@@ -51,21 +52,21 @@ bool Service::RunModule() {
     std::unique_ptr<event_base, EventBaseDeleter> base(event_base_new());
     if (!base)
     {
-        mylog::GetLogger("asynclogger")->Fatal("event_base_new err!"); // 记录致命错误
+        MYLOG_LOGGER("asynclogger")->Fatal("event_base_new err!"); // 记录致命错误
         return false;
     }
 
     std::unique_ptr<evhttp, EvhttpDeleter> httpd(evhttp_new(base.get()));
     if (!httpd)
     {
-        mylog::GetLogger("asynclogger")->Fatal("evhttp_new err!"); // 记录致命错误
+        MYLOG_LOGGER("asynclogger")->Fatal("evhttp_new err!"); // 记录致命错误
         return false;
     }
 
     // 绑定HTTP服务器到所有可用IP地址和指定端口
     if (evhttp_bind_socket(httpd.get(), "0.0.0.0", server_port_) != 0)
     {
-        mylog::GetLogger("asynclogger")->Fatal("evhttp_bind_socket failed!"); // 记录致命错误
+        MYLOG_LOGGER("asynclogger")->Fatal("evhttp_bind_socket failed!"); // 记录致命错误
         return false;
     }
 
@@ -73,7 +74,7 @@ bool Service::RunModule() {
     evhttp_set_gencb(httpd.get(), GenHandler, NULL);
 
     if(event_base_dispatch(base.get()) == -1) {
-        mylog::GetLogger("asynclogger")->Fatal("event_base_dispatch err"); // 记录致命错误
+        MYLOG_LOGGER("asynclogger")->Fatal("event_base_dispatch err"); // 记录致命错误
     }
 
     return true;
@@ -85,7 +86,7 @@ void Service::GenHandler(struct evhttp_request* req, void* arg)
     // 获取请求URI路径并进行URL解码
     std::string path = evhttp_uri_get_path(evhttp_request_get_evhttp_uri(req));
     path = UrlDecode(path); // 使用自定义的UrlDecode函数
-    mylog::GetLogger("asynclogger")->Info("get req, uri: %s", path.c_str()); // 记录请求URI
+    MYLOG_LOGGER("asynclogger")->Info("get req, uri: %s", path.c_str()); // 记录请求URI
 
     if(evhttp_request_get_command(req) == EVHTTP_REQ_OPTIONS) {
         struct evbuffer* buf = evhttp_request_get_output_buffer(req);
@@ -138,30 +139,30 @@ void Service::GenHandler(struct evhttp_request* req, void* arg)
 
 // Upload：处理文件上传请求
 void Service::Upload(struct evhttp_request* req, void* arg) {
-    mylog::GetLogger("asynclogger")->Info("Upload start"); // 记录日志
+    MYLOG_LOGGER("asynclogger")->Info("Upload start"); // 记录日志
 
     // 获取请求体缓冲区
     struct evbuffer* buf = evhttp_request_get_input_buffer(req);
     if (buf == nullptr)
     {
-        mylog::GetLogger("asynclogger")->Info("evhttp_request_get_input_buffer is empty");
+        MYLOG_LOGGER("asynclogger")->Info("evhttp_request_get_input_buffer is empty");
         return;
     }
 
     size_t len = evbuffer_get_length(buf); // 获取请求体长度
-    mylog::GetLogger("asynclogger")->Info("evbuffer_get_length is %u", len);
+    MYLOG_LOGGER("asynclogger")->Info("evbuffer_get_length is %zu", len);
     if (0 == len) // 如果请求体为空，返回错误
     {
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_BADREQUEST, "file empty", NULL);
-        mylog::GetLogger("asynclogger")->Info("request body is empty");
+        MYLOG_LOGGER("asynclogger")->Info("request body is empty");
         return;
     }
     std::string content(len, 0); // 创建字符串存储请求体内容
     if (-1 == evbuffer_copyout(buf, (void*)content.c_str(), len)) // 将缓冲区内容复制到字符串
     {
-        mylog::GetLogger("asynclogger")->Error("evbuffer_copyout error");
+        MYLOG_LOGGER("asynclogger")->Error("evbuffer_copyout error");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, NULL, NULL); // 服务器内部错误
@@ -188,7 +189,7 @@ void Service::Upload(struct evhttp_request* req, void* arg) {
     }
     else // 非法存储类型
     {
-        mylog::GetLogger("asynclogger")->Info("HTTP_BADREQUEST");
+        MYLOG_LOGGER("asynclogger")->Info("HTTP_BADREQUEST");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_BADREQUEST, "Illegal storage type", NULL);
@@ -240,12 +241,12 @@ void Service::Upload(struct evhttp_request* req, void* arg) {
                 ts_ss << file_extension;
             }
             final_storage_path = ts_ss.str();
-            mylog::GetLogger("asynclogger")->Warn("Used timestamp for unique filename: %s", final_storage_path.c_str());
+            MYLOG_LOGGER("asynclogger")->Warn("Used timestamp for unique filename: %s", final_storage_path.c_str());
             break;
         }
     } while (true);
     #ifdef DEBUG_LOG
-                mylog::GetLogger("asynclogger")->Debug("storage_path:%s", final_storage_path.c_str());
+                MYLOG_LOGGER("asynclogger")->Debug("storage_path:%s", final_storage_path.c_str());
     #endif
 
     // 根据存储类型写入文件 (low_storage直接写入，deep_storage压缩后写入)
@@ -254,7 +255,7 @@ void Service::Upload(struct evhttp_request* req, void* arg) {
     {
         if (fu.SetContent(content.c_str(), len) == false) // 直接写入内容
         {
-            mylog::GetLogger("asynclogger")->Error("low_storage fail: HTTP_INTERNAL");
+            MYLOG_LOGGER("asynclogger")->Error("low_storage fail: HTTP_INTERNAL");
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
             evhttp_send_reply(req, HTTP_INTERNAL, "server error", NULL); // 服务器内部错误
@@ -262,7 +263,7 @@ void Service::Upload(struct evhttp_request* req, void* arg) {
         }
         else
         {
-            mylog::GetLogger("asynclogger")->Info("low_storage success");
+            MYLOG_LOGGER("asynclogger")->Info("low_storage success");
         }
     }
     else // 深度存储
@@ -270,7 +271,7 @@ void Service::Upload(struct evhttp_request* req, void* arg) {
         // 压缩内容并写入文件，压缩格式从Config获取
         if (fu.Compress(content, Config::GetInstance()->GetBundleFormat()) == false)
         {
-            mylog::GetLogger("asynclogger")->Error("deep_storage fail: HTTP_INTERNAL");
+            MYLOG_LOGGER("asynclogger")->Error("deep_storage fail: HTTP_INTERNAL");
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
             evhttp_send_reply(req, HTTP_INTERNAL, "server error", NULL);
@@ -278,7 +279,7 @@ void Service::Upload(struct evhttp_request* req, void* arg) {
         }
         else
         {
-            mylog::GetLogger("asynclogger")->Info("deep_storage success");
+            MYLOG_LOGGER("asynclogger")->Info("deep_storage success");
         }
     }
 
@@ -290,7 +291,7 @@ void Service::Upload(struct evhttp_request* req, void* arg) {
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
     evhttp_send_reply(req, HTTP_OK, "Success", NULL); // 返回成功响应
-    mylog::GetLogger("asynclogger")->Info("upload finish:success");
+    MYLOG_LOGGER("asynclogger")->Info("upload finish:success");
 }
 
 // TimetoStr：将time_t时间转换为字符串 (此处仅为辅助，实际在ListShow中被generateModernFileList调用)
@@ -453,7 +454,7 @@ std::string Service::formatSize(uint64_t bytes) {
 
 // ListShow：处理文件列表展示请求
 void Service::ListShow(struct evhttp_request* req, void* arg) {
-    mylog::GetLogger("asynclogger")->Info("ListShow()"); // 记录日志
+    MYLOG_LOGGER("asynclogger")->Info("ListShow()"); // 记录日志
 
     // 1. 获取所有文件存储信息
     std::vector<StorageInfo> arry;
@@ -483,7 +484,7 @@ void Service::ListShow(struct evhttp_request* req, void* arg) {
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
     evhttp_send_reply(req, HTTP_OK, NULL, NULL); // 发送HTTP OK响应
-    mylog::GetLogger("asynclogger")->Info("ListShow() finish"); // 记录日志
+    MYLOG_LOGGER("asynclogger")->Info("ListShow() finish"); // 记录日志
 }
 
 // GetETag：根据文件信息生成ETag (用于缓存和断点续传)
@@ -500,18 +501,19 @@ std::string Service::GetETag(const StorageInfo& info) {
 
 // Download：处理文件下载请求
 void Service::Download(struct evhttp_request* req, void* arg) {
+    auto start = std::chrono::steady_clock::now(); // 用于记录下载请求的处理耗时
     // 1. 获取请求的资源路径，并获取对应的StorageInfo
     StorageInfo info;
     std::string resource_path = evhttp_uri_get_path(evhttp_request_get_evhttp_uri(req));
     resource_path = UrlDecode(resource_path); // URL解码
     data_->GetOneByURL(resource_path, &info); // 从DataManager获取StorageInfo
-    mylog::GetLogger("asynclogger")->Info("request resource_path:%s", resource_path.c_str()); // 记录日志
+    MYLOG_INFO(MYLOG_LOGGER("asynclogger"), "request resource_path:{}", resource_path); // 记录日志
 
     std::string download_path = info.storage_path_; // 初始下载路径为文件存储路径
     // 2. 如果是深度存储的文件，则先解压缩到临时目录
     if (info.storage_path_.find(Config::GetInstance()->GetLowStorageDir()) == std::string::npos) // 如果不是low_storage目录
     {
-        mylog::GetLogger("asynclogger")->Info("uncompressing:%s", info.storage_path_.c_str()); // 记录日志
+        MYLOG_LOGGER("asynclogger")->Info("uncompressing:%s", info.storage_path_.c_str()); // 记录日志
         FileUtil fu_compressed(info.storage_path_); // 操作压缩文件
         // 构建解压后的临时文件路径 (在low_storage目录下)
         download_path = Config::GetInstance()->GetLowStorageDir() +
@@ -520,13 +522,13 @@ void Service::Download(struct evhttp_request* req, void* arg) {
         dirCreate.CreateDirectory(); // 确保low_storage目录存在
         fu_compressed.UnCompress(download_path); // 解压缩文件
     }
-    mylog::GetLogger("asynclogger")->Info("request download_path:%s", download_path.c_str()); // 记录日志
+    MYLOG_LOGGER("asynclogger")->Info("request download_path:%s", download_path.c_str()); // 记录日志
 
     FileUtil fu_download(download_path); // 操作实际下载的文件
     if (fu_download.Exists() == false && info.storage_path_.find("deep_storage") != std::string::npos)
     {
         // 如果是压缩文件，且解压失败导致文件不存在，是服务器错误
-        mylog::GetLogger("asynclogger")->Info(": 500 - UnCompress failed");
+        MYLOG_LOGGER("asynclogger")->Info(": 500 - UnCompress failed");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, NULL, NULL);
@@ -534,7 +536,7 @@ void Service::Download(struct evhttp_request* req, void* arg) {
     else if (fu_download.Exists() == false && info.storage_path_.find("low_storage") == std::string::npos)
     {
         // 如果是普通文件，且文件不存在，是客户端的请求错误
-        mylog::GetLogger("asynclogger")->Info(": 400 - bad request,file not exists");
+        MYLOG_LOGGER("asynclogger")->Info(": 400 - bad request,file not exists");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_BADREQUEST, "file not exists", NULL);
@@ -551,14 +553,14 @@ void Service::Download(struct evhttp_request* req, void* arg) {
         if (old_etag == GetETag(info)) // 比较ETag
         {
             retrans = true;
-            mylog::GetLogger("asynclogger")->Info("%s need breakpoint continuous transmission", download_path.c_str());
+            MYLOG_LOGGER("asynclogger")->Info("%s need breakpoint continuous transmission", download_path.c_str());
         }
     }
 
     // 4. 读取文件数据，放入响应体中
     if (fu_download.Exists() == false) // 再次检查文件是否存在 (处理前面判断后的可能性)
     {
-        mylog::GetLogger("asynclogger")->Info("%s not exists", download_path.c_str());
+        MYLOG_LOGGER("asynclogger")->Info("%s not exists", download_path.c_str());
         download_path += "not exists"; // 附加信息以便客户端理解
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
@@ -569,7 +571,9 @@ void Service::Download(struct evhttp_request* req, void* arg) {
     int fd = open(download_path.c_str(), O_RDONLY); // 打开文件以供读取
     if (fd == -1) // 检查文件是否成功打开
     {
-        mylog::GetLogger("asynclogger")->Error("open file error: %s -- %s", download_path.c_str(), strerror(errno));
+        // 磁盘故障时每个下载请求都会失败，限流避免错误日志刷屏，被拦下的条数会汇总输出
+        if (MYLOG_ALLOW(MYLOG_LOGGER("asynclogger"), mylog::LogLevel::value::ERROR, mylog::LimitPolicy::Rate(10)))
+            MYLOG_LOGGER("asynclogger")->Error("open file error: %s -- %s", download_path.c_str(), strerror(errno));
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, strerror(errno), NULL);
@@ -578,7 +582,7 @@ void Service::Download(struct evhttp_request* req, void* arg) {
     // 将文件内容添加到输出缓冲区，效率较高 (evbuffer_add_file会直接映射文件)
     if (-1 == evbuffer_add_file(outbuf, fd, 0, fu_download.FileSize()))
     {
-        mylog::GetLogger("asynclogger")->Error("evbuffer_add_file: %d -- %s -- %s", fd, download_path.c_str(), strerror(errno));
+        MYLOG_LOGGER("asynclogger")->Error("evbuffer_add_file: %d -- %s -- %s", fd, download_path.c_str(), strerror(errno));
     }
 
     // 5. 设置响应头部字段： ETag， Accept-Ranges: bytes
@@ -591,15 +595,19 @@ void Service::Download(struct evhttp_request* req, void* arg) {
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_OK, "Success", NULL); // 返回200 OK
-        mylog::GetLogger("asynclogger")->Info(": HTTP_OK");
     }
     else // 断点续传请求
     {
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, 206, "breakpoint continuous transmission", NULL); // 返回206 Partial Content
-        mylog::GetLogger("asynclogger")->Info(": 206");
     }
+    // 结构化字段供日志分析工具直接读取，不必解析信息体
+    MYLOG_INFO(MYLOG_LOGGER("asynclogger"), "download done",
+        mylog::KV("url", resource_path),
+        mylog::KV("bytes", fu_download.FileSize()),
+        mylog::KV("latency_us", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()),
+        mylog::KV("status", retrans ? 206 : HTTP_OK));
 
     // 清理：如果下载路径是临时解压文件，则删除它
     if (download_path != info.storage_path_)
@@ -610,12 +618,12 @@ void Service::Download(struct evhttp_request* req, void* arg) {
 
 // Delete：处理文件删除请求
 void Service::Delete(struct evhttp_request* req, void* arg) {
-    mylog::GetLogger("asynclogger")->Info("Delete start");
+    MYLOG_LOGGER("asynclogger")->Info("Delete start");
     
     std::string url_to_delete;
     // 处理GET请求 - 从URL参数获取
     const char* uri = evhttp_request_get_uri(req);
-    mylog::GetLogger("asynclogger")->Info("Delete GET request URI: %s", uri);
+    MYLOG_LOGGER("asynclogger")->Info("Delete GET request URI: %s", uri);
     
     // 解析查询参数
     struct evkeyvalq params;
@@ -624,24 +632,24 @@ void Service::Delete(struct evhttp_request* req, void* arg) {
     const char* url_param = evhttp_find_header(&params, "url");
     if (url_param) {
         url_to_delete = UrlDecode(url_param); // URL解码
-        mylog::GetLogger("asynclogger")->Info("Delete URL from GET params: %s", url_to_delete.c_str());
+        MYLOG_LOGGER("asynclogger")->Info("Delete URL from GET params: %s", url_to_delete.c_str());
     }
     evhttp_clear_headers(&params); // 清理参数头
 
     if (url_to_delete.empty()) {
-        mylog::GetLogger("asynclogger")->Error("Delete request missing url parameter");
+        MYLOG_LOGGER("asynclogger")->Error("Delete request missing url parameter");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_BADREQUEST, "Missing url parameter", NULL);
         return;
     }
     
-    mylog::GetLogger("asynclogger")->Info("Attempting to delete file with URL: %s", url_to_delete.c_str());
+    MYLOG_LOGGER("asynclogger")->Info("Attempting to delete file with URL: %s", url_to_delete.c_str());
     
     // 从DataManager中获取StorageInfo
     StorageInfo info;
     if (!data_->GetOneByURL(url_to_delete, &info)) {
-        mylog::GetLogger("asynclogger")->Error("File not found in DataManager: %s", url_to_delete.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("File not found in DataManager: %s", url_to_delete.c_str());
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_NOTFOUND, "File not found", NULL);
@@ -654,7 +662,7 @@ void Service::Delete(struct evhttp_request* req, void* arg) {
     
     FileUtil dirCreate(dest_dir);
     if(!dirCreate.CreateDirectory()){
-        mylog::GetLogger("asynclogger")->Error("Failed to create recycle bin directory: %s", dest_dir.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to create recycle bin directory: %s", dest_dir.c_str());
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, "Failed to create recycle bin directory", NULL);
@@ -673,7 +681,7 @@ void Service::Delete(struct evhttp_request* req, void* arg) {
     recycle_info.origin_type_ = (storage_type == "low") ? "low" : "deep"; // 设置原始存储类型
     
     if(!recycle_data_->Insert(recycle_info)){
-        mylog::GetLogger("asynclogger")->Error("Failed to insert file into recycle bin: %s", url_to_delete.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to insert file into recycle bin: %s", url_to_delete.c_str());
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, "Failed to move file to recycle bin", NULL);
@@ -682,7 +690,7 @@ void Service::Delete(struct evhttp_request* req, void* arg) {
 
     // 移动物理文件
     if(rename(info.storage_path_.c_str(), dest_path.c_str()) != 0) {
-        mylog::GetLogger("asynclogger")->Error("Failed to move file to recycle bin: %s", strerror(errno));
+        MYLOG_LOGGER("asynclogger")->Error("Failed to move file to recycle bin: %s", strerror(errno));
         // 回滚
         recycle_data_->Delete(url_to_delete); // 如果移动失败，删除回收站记录
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
@@ -693,7 +701,7 @@ void Service::Delete(struct evhttp_request* req, void* arg) {
 
     // 删除原来的文件信息
     if(!data_->Delete(url_to_delete)) {
-        mylog::GetLogger("asynclogger")->Error("Failed to delete file from DataManager: %s", url_to_delete.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to delete file from DataManager: %s", url_to_delete.c_str());
         // 回滚
         rename(dest_path.c_str(), info.storage_path_.c_str()); // 如果删除失败，恢复文件
         recycle_data_->Delete(url_to_delete); // 删除回收站记录
@@ -707,16 +715,16 @@ void Service::Delete(struct evhttp_request* req, void* arg) {
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
     evhttp_send_reply(req, 302, "Found", NULL);
-    mylog::GetLogger("asynclogger")->Info("File moved to recycle bin, redirecting to main page");
+    MYLOG_LOGGER("asynclogger")->Info("File moved to recycle bin, redirecting to main page");
 }
 
 // Restore: 处理文件恢复请求
 void Service::Restore(struct evhttp_request* req, void* arg) {
-    mylog::GetLogger("asynclogger")->Info("Restore start");
+    MYLOG_LOGGER("asynclogger")->Info("Restore start");
     std::string url_to_restore;
     // 处理GET请求 - 从URL参数获取
     const char* uri = evhttp_request_get_uri(req);
-    mylog::GetLogger("asynclogger")->Info("Restore GET request URI: %s", uri);
+    MYLOG_LOGGER("asynclogger")->Info("Restore GET request URI: %s", uri);
     
     // 解析参数
     struct evkeyvalq params;
@@ -725,30 +733,30 @@ void Service::Restore(struct evhttp_request* req, void* arg) {
     const char* url_param = evhttp_find_header(&params, "url");
     if(url_param) {
         url_to_restore = UrlDecode(url_param);
-        mylog::GetLogger("asynclogger")->Info("Restore URL from GET params: %s", url_to_restore.c_str());
+        MYLOG_LOGGER("asynclogger")->Info("Restore URL from GET params: %s", url_to_restore.c_str());
     }
     evhttp_clear_headers(&params);
 
     if(url_to_restore.empty()){
-        mylog::GetLogger("asynclogger")->Error("Restore request missing url parameter");
+        MYLOG_LOGGER("asynclogger")->Error("Restore request missing url parameter");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_BADREQUEST, "Missing url parameter", NULL);
         return;
     }
 
-    mylog::GetLogger("asynclogger")->Info("Attempting to restore file with URL: %s", url_to_restore.c_str());
+    MYLOG_LOGGER("asynclogger")->Info("Attempting to restore file with URL: %s", url_to_restore.c_str());
 
     // 从回收站获取StorageInfo
     StorageInfo info;
     if (!recycle_data_->GetOneByURL(url_to_restore, &info)) {
-        mylog::GetLogger("asynclogger")->Error("Failed to get file info from recycle bin: %s", url_to_restore.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to get file info from recycle bin: %s", url_to_restore.c_str());
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_NOTFOUND, "File not found in recycle bin", NULL);
         return;
     }
-    mylog::GetLogger("asynclogger")->Info("Restoring file: %s", info.storage_path_.c_str());
+    MYLOG_LOGGER("asynclogger")->Info("Restoring file: %s", info.storage_path_.c_str());
 
     // 确定目标存储路径
     std::string storage_type = (info.origin_type_ == "low") ? Config::GetInstance()->GetLowStorageDir() : Config::GetInstance()->GetDeepStorageDir();
@@ -759,7 +767,7 @@ void Service::Restore(struct evhttp_request* req, void* arg) {
     new_info.origin_type_ = info.origin_type_; // 恢复原始存储类型
 
     if(!data_->Insert(new_info)) {
-        mylog::GetLogger("asynclogger")->Error("Failed to insert restored file into DataManager: %s", url_to_restore.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to insert restored file into DataManager: %s", url_to_restore.c_str());
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, "Failed to restore file", NULL);
@@ -767,7 +775,7 @@ void Service::Restore(struct evhttp_request* req, void* arg) {
     }
 
     if(rename(info.storage_path_.c_str(), dest_path.c_str()) != 0) {
-        mylog::GetLogger("asynclogger")->Error("Failed to restore file: %s", strerror(errno));
+        MYLOG_LOGGER("asynclogger")->Error("Failed to restore file: %s", strerror(errno));
         data_->Delete(url_to_restore); // 回滚，删除新插入的记录
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
@@ -776,7 +784,7 @@ void Service::Restore(struct evhttp_request* req, void* arg) {
     }
 
     if(!recycle_data_->Delete(url_to_restore)) {
-        mylog::GetLogger("asynclogger")->Error("Failed to delete file from recycle bin: %s", url_to_restore.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to delete file from recycle bin: %s", url_to_restore.c_str());
         rename(dest_path.c_str(), info.storage_path_.c_str()); // 回滚，恢复文件
         data_->Delete(url_to_restore); // 删除新插入的记录
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
@@ -789,16 +797,16 @@ void Service::Restore(struct evhttp_request* req, void* arg) {
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
     evhttp_send_reply(req, 302, "Found", NULL);
-    mylog::GetLogger("asynclogger")->Info("File restored, redirecting to recycle page");
+    MYLOG_LOGGER("asynclogger")->Info("File restored, redirecting to recycle page");
 }
 
 // DeleteRecycle: 处理回收站文件删除请求
 void Service::DeleteRecycle(struct evhttp_request* req, void* arg) {
-    mylog::GetLogger("asynclogger")->Info("DeleteRecycle start");
+    MYLOG_LOGGER("asynclogger")->Info("DeleteRecycle start");
     std::string url_to_delete;
     // 处理GET请求 - 从URL参数获取
     const char* uri = evhttp_request_get_uri(req);
-    mylog::GetLogger("asynclogger")->Info("DeleteRecycle GET request URI: %s", uri);
+    MYLOG_LOGGER("asynclogger")->Info("DeleteRecycle GET request URI: %s", uri);
     
     // 解析参数
     struct evkeyvalq params;
@@ -807,34 +815,34 @@ void Service::DeleteRecycle(struct evhttp_request* req, void* arg) {
     const char* url_param = evhttp_find_header(&params, "url");
     if(url_param) {
         url_to_delete = UrlDecode(url_param);
-        mylog::GetLogger("asynclogger")->Info("DeleteRecycle URL from GET params: %s", url_to_delete.c_str());
+        MYLOG_LOGGER("asynclogger")->Info("DeleteRecycle URL from GET params: %s", url_to_delete.c_str());
     }
     evhttp_clear_headers(&params);
 
     if(url_to_delete.empty()){
-        mylog::GetLogger("asynclogger")->Error("DeleteRecycle request missing url parameter");
+        MYLOG_LOGGER("asynclogger")->Error("DeleteRecycle request missing url parameter");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_BADREQUEST, "Missing url parameter", NULL);
         return;
     }
 
-    mylog::GetLogger("asynclogger")->Info("Attempting to delete file with URL: %s", url_to_delete.c_str());
+    MYLOG_LOGGER("asynclogger")->Info("Attempting to delete file with URL: %s", url_to_delete.c_str());
 
     // 从回收站获取StorageInfo
     StorageInfo info;
     if (!recycle_data_->GetOneByURL(url_to_delete, &info)) {
-        mylog::GetLogger("asynclogger")->Error("Failed to get file info from recycle bin: %s", url_to_delete.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to get file info from recycle bin: %s", url_to_delete.c_str());
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_NOTFOUND, "File not found in recycle bin", NULL);
         return;
     }
-    mylog::GetLogger("asynclogger")->Info("Delete file: %s", info.storage_path_.c_str());
+    MYLOG_LOGGER("asynclogger")->Info("Delete file: %s", info.storage_path_.c_str());
 
     // 删除物理文件
     if(remove(info.storage_path_.c_str()) != 0) {
-        mylog::GetLogger("asynclogger")->Error("Failed to delete file: %s", strerror(errno));
+        MYLOG_LOGGER("asynclogger")->Error("Failed to delete file: %s", strerror(errno));
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, "Failed to delete file", NULL);
@@ -843,7 +851,7 @@ void Service::DeleteRecycle(struct evhttp_request* req, void* arg) {
 
     // 从回收站删除记录
     if(!recycle_data_->Delete(url_to_delete)) {
-        mylog::GetLogger("asynclogger")->Error("Failed to delete file from recycle bin: %s", url_to_delete.c_str());
+        MYLOG_LOGGER("asynclogger")->Error("Failed to delete file from recycle bin: %s", url_to_delete.c_str());
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
         evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
         evhttp_send_reply(req, HTTP_INTERNAL, "Failed to delete file from recycle bin", NULL);
@@ -854,12 +862,12 @@ void Service::DeleteRecycle(struct evhttp_request* req, void* arg) {
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
     evhttp_send_reply(req, 302, "Found", NULL); // 重定向
-    mylog::GetLogger("asynclogger")->Info("File permanently deleted, redirecting to recycle page");
+    MYLOG_LOGGER("asynclogger")->Info("File permanently deleted, redirecting to recycle page");
 }
 
 // RecycleList: 处理回收站文件列表请求
 void Service::RecycleList(struct evhttp_request* req, void* arg) {
-    mylog::GetLogger("asynclogger")->Info("RecycleList() - Recycle page"); // 记录日志
+    MYLOG_LOGGER("asynclogger")->Info("RecycleList() - Recycle page"); // 记录日志
 
     // 1. 获取所有文件存储信息
     std::vector<StorageInfo> recycle_files;
@@ -889,11 +897,11 @@ void Service::RecycleList(struct evhttp_request* req, void* arg) {
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
     evhttp_send_reply(req, HTTP_OK, NULL, NULL); // 发送HTTP OK响应
-    mylog::GetLogger("asynclogger")->Info("RecycleList() finish"); // 记录日志
+    MYLOG_LOGGER("asynclogger")->Info("RecycleList() finish"); // 记录日志
 }
 
 void Service::RecycleClear(struct evhttp_request* req, void* arg) {
-    mylog::GetLogger("asynclogger")->Info("RecycleClean() - Cleaning up recycle bin");
+    MYLOG_LOGGER("asynclogger")->Info("RecycleClean() - Cleaning up recycle bin");
     
     // 1. 获取所有文件存储信息
     std::vector<StorageInfo> recycle_files;
@@ -901,9 +909,9 @@ void Service::RecycleClear(struct evhttp_request* req, void* arg) {
 
     // 2. 遍历回收站文件，执行清理操作
     for (const auto& file : recycle_files) {
-        mylog::GetLogger("asynclogger")->Info("Deleting file from recycle bin: %s", file.storage_path_.c_str());
+        MYLOG_LOGGER("asynclogger")->Info("Deleting file from recycle bin: %s", file.storage_path_.c_str());
         if(remove(file.storage_path_.c_str()) != 0) {
-            mylog::GetLogger("asynclogger")->Error("Failed to delete file: %s", strerror(errno));
+            MYLOG_LOGGER("asynclogger")->Error("Failed to delete file: %s", strerror(errno));
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
             evhttp_send_reply(req, HTTP_INTERNAL, "Failed to delete file", NULL);
@@ -911,7 +919,7 @@ void Service::RecycleClear(struct evhttp_request* req, void* arg) {
         }
 
         if(!recycle_data_->Delete(file.url_)) {
-            mylog::GetLogger("asynclogger")->Error("Failed to delete file from recycle bin: %s", file.url_.c_str());
+            MYLOG_LOGGER("asynclogger")->Error("Failed to delete file from recycle bin: %s", file.url_.c_str());
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
             evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
             evhttp_send_reply(req, HTTP_INTERNAL, "Failed to delete file from recycle bin", NULL);
@@ -924,6 +932,6 @@ void Service::RecycleClear(struct evhttp_request* req, void* arg) {
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Origin", "*");
     evhttp_add_header(req->output_headers, "Access-Control-Allow-Headers", "content-type,filename,storagetype");
     evhttp_send_reply(req, 302, "Found", NULL); // 重定向
-    mylog::GetLogger("asynclogger")->Info("RecycleClean() - Recycle bin cleaned successfully");
+    MYLOG_LOGGER("asynclogger")->Info("RecycleClean() - Recycle bin cleaned successfully");
 }
 };
\ No newline at end of file
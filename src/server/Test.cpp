@@ -15,7 +15,7 @@ mylog::Util::JsonData* g_conf_data;
 void service_module()
 {
     storage::Service s;
-    mylog::GetLogger("asynclogger")->Info("service step in RunModule");
+    MYLOG_LOGGER("asynclogger")->Info("service step in RunModule");
     s.RunModule();
 }
 
@@ -27,6 +27,8 @@ void log_system_module_init()
     Glb->BuildLoggerName("asynclogger");
     Glb->BuildLoggerFlush<mylog::RollFileFlush>("./logfile/RollFile_log",
                                               1024 * 1024);
+    Glb->BuildDeferredFormat(); // MYLOG_*宏的日志只拷贝参数，由消费者线程格式化
+    Glb->BuildBackup(); // ERROR/FATAL日志发送到远程备份服务器
     // The LoggerManger has been built and is managed by members of the LoggerManger class
     //The logger is assigned to the managed object, and the caller lands the log by invoking the singleton managed object
     mylog::LoggerManager::GetInstance().AddLogger(Glb->Build());
@@ -73,7 +73,7 @@ namespace storage
 			auto ret = stat(filename_.c_str(), &s); // 获取文件状态信息
             if (ret == -1)
             {
-				mylog::GetLogger("asynclogger")->Info("%s, Get file size failed: %s", filename_.c_str(), strerror(errno)); // 错误日志，内容格式：文件名,Get file size failed: 错误信息
+				MYLOG_LOGGER("asynclogger")->Info("%s, Get file size failed: %s", filename_.c_str(), strerror(errno)); // 错误日志，内容格式：文件名,Get file size failed: 错误信息
                 return -1;
             }
             return s.st_size;
@@ -85,7 +85,7 @@ namespace storage
             auto ret = stat(filename_.c_str(), &s);
             if (ret == -1)
             {
-                mylog::GetLogger("asynclogger")->Info("%s, Get file access time failed: %s", filename_.c_str(),strerror(errno));
+                MYLOG_LOGGER("asynclogger")->Info("%s, Get file access time failed: %s", filename_.c_str(),strerror(errno));
                 return -1;
             }
             return s.st_atime;
@@ -98,7 +98,7 @@ namespace storage
             auto ret = stat(filename_.c_str(), &s);
             if (ret == -1)
             {
-                mylog::GetLogger("asynclogger")->Info("%s, Get file modify time failed: %s",filename_.c_str(), strerror(errno));
+                MYLOG_LOGGER("asynclogger")->Info("%s, Get file modify time failed: %s",filename_.c_str(), strerror(errno));
                 return -1;
             }
             return s.st_mtime;
@@ -119,7 +119,7 @@ namespace storage
             // 判断要求数据内容是否符合文件大小
             if (pos + len > FileSize())
             {
-                mylog::GetLogger("asynclogger")->Info("needed data larger than file size");
+                MYLOG_LOGGER("asynclogger")->Info("needed data larger than file size");
                 return false;
             }
 
@@ -128,7 +128,7 @@ namespace storage
 			ifs.open(filename_.c_str(), std::ios::binary); // 以二进制模式打开文件
             if (ifs.is_open() == false)
             {
-                mylog::GetLogger("asynclogger")->Info("%s,file open error",filename_.c_str());
+                MYLOG_LOGGER("asynclogger")->Info("%s,file open error",filename_.c_str());
                 return false;
             }
 
@@ -138,7 +138,7 @@ namespace storage
 			ifs.read(&(*content)[0], len); // 从文件中读取指定长度的数据到content中
             if (!ifs.good())
             {
-                mylog::GetLogger("asynclogger")->Info("%s,read file content error",filename_.c_str());
+                MYLOG_LOGGER("asynclogger")->Info("%s,read file content error",filename_.c_str());
                 ifs.close();
                 return false;
             }
@@ -160,13 +160,13 @@ namespace storage
             ofs.open(filename_.c_str(), std::ios::binary);
             if (!ofs.is_open())
             {
-                mylog::GetLogger("asynclogger")->Info("%s open error: %s", filename_.c_str(), strerror(errno));
+                MYLOG_LOGGER("asynclogger")->Info("%s open error: %s", filename_.c_str(), strerror(errno));
                 return false;
             }
 			ofs.write(content, len); // 将内容写入文件
             if (!ofs.good())
             {
-                mylog::GetLogger("asynclogger")->Info("%s, file set content error",filename_.c_str());
+                MYLOG_LOGGER("asynclogger")->Info("%s, file set content error",filename_.c_str());
                 ofs.close();
             }
             ofs.close();
@@ -182,14 +182,14 @@ namespace storage
 			std::string packed = bundle::pack(format, content); // 对内容进行压缩 format指定压缩格式 如1代表gzip，2代表zlib等
 			if (packed.size() == 0)// 如果压缩后的数据大小为0，说明压缩失败
             {
-                mylog::GetLogger("asynclogger")->Info("Compress packed size error:%d", packed.size());
+                MYLOG_LOGGER("asynclogger")->Info("Compress packed size error:%zu", packed.size());
                 return false;
             }
             // 将压缩的数据写入压缩包文件中
 			FileUtil f(filename_); // 创建FileUtil对象，指定压缩包文件名
 			if (f.SetContent(packed.c_str(), packed.size()) == false)// 如果写入压缩包文件失败
             {
-                mylog::GetLogger("asynclogger")->Info("filename:%s, Compress SetContent error",filename_.c_str());
+                MYLOG_LOGGER("asynclogger")->Info("filename:%s, Compress SetContent error",filename_.c_str());
                 return false;
             }
             return true;
@@ -200,7 +200,7 @@ namespace storage
             std::string body;
 			if (this->GetContent(&body) == false) // 如果获取压缩包内容失败
             {
-                mylog::GetLogger("asynclogger")->Info("filename:%s, uncompress get file content failed!",filename_.c_str());
+                MYLOG_LOGGER("asynclogger")->Info("filename:%s, uncompress get file content failed!",filename_.c_str());
                 return false;
             }
             // 对压缩的数据进行解压缩
@@ -209,7 +209,7 @@ namespace storage
 			FileUtil fu(download_path); // 创建FileUtil对象，指定解压缩后的文件名
             if (fu.SetContent(unpacked.c_str(), unpacked.size()) == false)
             {
-                mylog::GetLogger("asynclogger")->Info("filename:%s, uncompress write packed data failed!",filename_.c_str());
+                MYLOG_LOGGER("asynclogger")->Info("filename:%s, uncompress write packed data failed!",filename_.c_str());
                 return false;
             }
             return true;
@@ -254,7 +254,7 @@ namespace storage
             std::stringstream ss;
             if (usw->write(val, &ss) != 0)
             {
-                mylog::GetLogger("asynclogger")->Info("serialize error");
+                MYLOG_LOGGER("asynclogger")->Info("serialize error");
                 return false;
             }
             *str = ss.str();
@@ -268,7 +268,7 @@ namespace storage
             std::string err;
             if (ucr->parse(str.c_str(), str.c_str() + str.size(), val, &err) == false)
             {
-                mylog::GetLogger("asynclogger")->Info("parse error");
+                MYLOG_LOGGER("asynclogger")->Info("parse error");
                 return false;
             }
             return true;